@@ -6,15 +6,22 @@
  * Optimizations:
  * 1. Reusable solver context (avoids repeated malloc/free)
  * 2. Early exit at 2 solutions (don't count beyond what's needed)
- * 3. Parallel generation (try multiple solution boards concurrently)
+ * 3. Parallel generation (try multiple solution boards concurrently) on a
+ *    persistent worker pool whose threads keep warm solver contexts
  */
 
+#define _POSIX_C_SOURCE 200112L  // sysconf()
+
 #include "generator.h"
 #include "solver.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <time.h>
+#include <unistd.h>
 
 // Fact types for constraint selection
 typedef enum {
@@ -74,8 +81,11 @@ static const struct {
     {4, 4, 6, 30, 2, 3, 0, 0, 5},
 };
 
-// Number of parallel workers for generation
-#define NUM_WORKERS 4
+// Parallel generation draws its attempts from this many independent RNG
+// streams, each trying up to ATTEMPTS_PER_STREAM solution boards. Part of
+// the seed-to-puzzle mapping: changing either changes generated puzzles.
+#define GENERATION_STREAMS 4
+#define ATTEMPTS_PER_STREAM 15
 
 GeneratorConfig generator_default_config(Difficulty level) {
     GeneratorConfig config = {0};
@@ -304,24 +314,62 @@ static bool is_redundant_or_conflicting(const Puzzle* puzzle, const Constraint*
     return false;
 }
 
+/**
+ * Cells of a complete board that count towards each shape, the way the
+ * solver counts them (the shape itself or a Cat)
+ */
+static void board_match_masks(const uint8_t* board, int total_cells, uint64_t* matches) {
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        matches[s] = 0;
+    }
+    for (int i = 0; i < total_cells; i++) {
+        matches[board[i]] |= 1ULL << i;
+    }
+    for (int s = SHAPE_SQUARE; s < SHAPE_COUNT; s++) {
+        matches[s] |= matches[SHAPE_CAT];
+    }
+}
+
+/**
+ * Check a constraint (with its cell_mask set) against a complete board
+ * given by its board_match_masks()
+ */
+static bool constraint_holds(const Constraint* c, const uint64_t* matches) {
+    uint8_t lo, hi;
+    solver_constraint_bounds(c, &lo, &hi);
+    
+    int count = __builtin_popcountll(c->cell_mask & matches[c->shape]);
+    return count >= lo && count <= hi;
+}
+
 // Debug flag - set to true to enable debug output
-static bool g_debug = false;
+static atomic_bool g_debug = false;
 
-// Profiling counters
-static int g_solver_calls = 0;
-static double g_solver_time_ms = 0;
+// Profiling counters (updated from every generation thread)
+static atomic_int g_solver_calls = 0;
+static atomic_llong g_solver_clocks = 0;
 
 void generator_set_debug(bool enable) {
-    g_debug = enable;
     if (enable) {
-        g_solver_calls = 0;
-        g_solver_time_ms = 0;
+        atomic_store(&g_solver_calls, 0);
+        atomic_store(&g_solver_clocks, 0);
     }
+    atomic_store(&g_debug, enable);
 }
 
 void generator_get_profile_stats(int* solver_calls, double* solver_time_ms) {
-    if (solver_calls) *solver_calls = g_solver_calls;
-    if (solver_time_ms) *solver_time_ms = g_solver_time_ms;
+    if (solver_calls) *solver_calls = atomic_load(&g_solver_calls);
+    if (solver_time_ms) {
+        *solver_time_ms = ((double)atomic_load(&g_solver_clocks) / CLOCKS_PER_SEC) * 1000.0;
+    }
+}
+
+/**
+ * Count one uniqueness check for --profile
+ */
+static void note_solver_call(clock_t start, clock_t end) {
+    atomic_fetch_add_explicit(&g_solver_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_solver_clocks, (long long)(end - start), memory_order_relaxed);
 }
 
 /**
@@ -448,6 +496,219 @@ static bool would_exceed_quota(const Constraint* c, const ConstraintQuotas* quot
     return false;
 }
 
+/**
+ * Best-ranked fact that can still be added and that the given solution
+ * board fails (the rank index into indices/scores), or -1 if none
+ */
+static int pick_separating_fact(const GeneratorConfig* config, const Puzzle* puzzle,
+                                const Fact* facts, const int* indices, const int* scores,
+                                int num_facts, const ConstraintQuotas* quotas,
+                                const uint8_t* counterexample) {
+    uint64_t matches[SHAPE_COUNT];
+    board_match_masks(counterexample, config->width * config->height, matches);
+    
+    for (int i = 0; i < num_facts; i++) {
+        // Skip facts with negative scores (quota exceeded or already tried)
+        if (scores[i] < 0) continue;
+        
+        Constraint c = fact_to_constraint(&facts[indices[i]], config->width);
+        
+        if (is_redundant_or_conflicting(puzzle, &c)) {
+            continue;
+        }
+        
+        // Enforce quotas in phase 3 as well
+        if (would_exceed_quota(&c, quotas, config)) {
+            continue;
+        }
+        
+        c.cell_mask = solver_constraint_mask(&c, config->width, config->height);
+        if (!constraint_holds(&c, matches)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Solutions a sample is drawn from, per sampled solution kept
+#define SAMPLE_POOL_FACTOR 16
+
+// Surviving samples are tracked in a uint64_t bitmask
+_Static_assert(GENERATOR_MAX_SAMPLES <= 64, "sample survivors must fit a 64-bit mask");
+
+/**
+ * Uniform sample of the first limit * SAMPLE_POOL_FACTOR solutions
+ * visited by solver_enumerate() (reservoir sampling)
+ */
+typedef struct {
+    RNG* rng;
+    int limit;
+    int seen;
+    int total_cells;
+    uint8_t boards[GENERATOR_MAX_SAMPLES][MAX_CELLS];
+} SolutionSample;
+
+static bool collect_solution(const uint8_t* board, void* user) {
+    SolutionSample* sample = user;
+    int slot = (sample->seen < sample->limit) ? sample->seen : rng_int(sample->rng, sample->seen + 1);
+    if (slot < sample->limit) {
+        memcpy(sample->boards[slot], board, sample->total_cells);
+    }
+    sample->seen++;
+    return sample->seen < sample->limit * SAMPLE_POOL_FACTOR;
+}
+
+/**
+ * Phases 2 and 3 with information-gain ranking (config->sample_solutions)
+ * 
+ * One enumeration both answers "unique?" and samples solutions of the
+ * current puzzle. Facts are then ranked by how many sampled solutions
+ * they rule out (ties keep score order), and added without further
+ * solves while at least two samples survive: those are still solutions,
+ * so the puzzle cannot be unique yet. Once fewer than two survive, the
+ * puzzle is sampled again.
+ * 
+ * The sample is drawn from the first solutions in search order, not from
+ * all of them: on puzzles with many more solutions than that, it leans
+ * towards boards that share the search's early cell choices, and so
+ * towards facts about the last cells searched.
+ * 
+ * A fact that rules out every survivor is only taken when no other fact
+ * rules out any: it is then checked like phase 3 does, by sampling right
+ * away, and rolled back if it leaves no solution.
+ */
+static bool select_by_sampling(const GeneratorConfig* config, RNG* rng, const Fact* facts,
+                               const int* indices, int* scores, int num_facts,
+                               ConstraintQuotas* quotas, Puzzle* puzzle,
+                               SolverContext* solver_ctx, const SolverLimits* limits) {
+    int total_cells = config->width * config->height;
+    SolutionSample sample;
+    sample.rng = rng;
+    sample.limit = config->sample_solutions < 2 ? 2 :
+                   config->sample_solutions > GENERATOR_MAX_SAMPLES ? GENERATOR_MAX_SAMPLES :
+                   config->sample_solutions;
+    sample.total_cells = total_cells;
+    uint64_t alive = 0;  // Bit b set while sample.boards[b] satisfies the puzzle
+    uint64_t matches[GENERATOR_MAX_SAMPLES][SHAPE_COUNT];  // Of each sampled board
+    
+    // Fact that ruled out every survivor, until sampling confirms it
+    int pending = -1;
+    uint64_t pending_alive = 0;
+    Constraint pending_c = {0};
+    
+    for (;;) {
+        if (__builtin_popcountll(alive) < 2) {
+            solver_precompute_masks(puzzle);
+            for (int j = 0; j < total_cells; j++) {
+                if (!is_locked(puzzle, j)) puzzle->board[j] = SHAPE_CAT;
+            }
+            
+            // No solution leaves the boards untouched, which a roll back
+            // below relies on
+            sample.seen = 0;
+            clock_t start = clock();
+            SolverResult result = solver_enumerate(solver_ctx, puzzle, collect_solution,
+                                                   &sample, limits);
+            clock_t end = clock();
+            
+            if (g_debug) {
+                note_solver_call(start, end);
+                printf("    [DEBUG] After %d constraints: %d solution(s) visited\n",
+                       puzzle->num_constraints, sample.seen);
+            }
+            
+            // Stopped by limits: the sample says nothing about uniqueness
+            if (result.status != SOLVE_COMPLETE) {
+                return false;
+            }
+            
+            if (sample.seen == 0 && pending >= 0) {
+                // Roll back constraint and quota tracking
+                puzzle->num_constraints--;
+                scores[pending] = -1;
+                if (pending_c.type == CONSTRAINT_CELL) {
+                    if (pending_c.op == OP_IS) {
+                        quotas->cell_is_count--;
+                    } else if (pending_c.op == OP_IS_NOT && pending_c.shape == SHAPE_CAT) {
+                        quotas->cell_is_not_cat_count--;
+                    }
+                } else {
+                    quotas->count_constraint_count--;
+                }
+                alive = pending_alive;
+                pending = -1;
+                continue;
+            }
+            
+            pending = -1;
+            if (sample.seen < 2) {
+                return sample.seen == 1;
+            }
+            int kept = (sample.seen < sample.limit) ? sample.seen : sample.limit;
+            alive = (kept == GENERATOR_MAX_SAMPLES) ? ~0ULL : (1ULL << kept) - 1;
+            for (int b = 0; b < kept; b++) {
+                board_match_masks(sample.boards[b], total_cells, matches[b]);
+            }
+        }
+        
+        if (puzzle->num_constraints >= config->max_constraints) {
+            return false;
+        }
+        
+        int pick = -1;
+        int best_ruled_out = 0;
+        uint64_t best_mask = 0;
+        int sweeping = -1;  // Best-ranked fact that rules out every survivor
+        int num_alive = __builtin_popcountll(alive);
+        
+        for (int i = 0; i < num_facts; i++) {
+            // Skip facts with negative scores (quota exceeded or rolled back)
+            if (scores[i] < 0) continue;
+            
+            Constraint c = fact_to_constraint(&facts[indices[i]], config->width);
+            
+            if (is_redundant_or_conflicting(puzzle, &c) ||
+                would_exceed_quota(&c, quotas, config)) {
+                continue;
+            }
+            
+            uint64_t ruled_out = 0;
+            c.cell_mask = solver_constraint_mask(&c, config->width, config->height);
+            for (uint64_t rest = alive; rest; rest &= rest - 1) {
+                int b = __builtin_ctzll(rest);
+                if (!constraint_holds(&c, matches[b])) {
+                    ruled_out |= 1ULL << b;
+                }
+            }
+            
+            int n = __builtin_popcountll(ruled_out);
+            if (n == num_alive) {
+                if (sweeping < 0) sweeping = i;
+            } else if (n > best_ruled_out) {
+                pick = i;
+                best_ruled_out = n;
+                best_mask = ruled_out;
+            }
+        }
+        
+        if (pick < 0 && sweeping >= 0) {
+            pick = sweeping;
+            best_mask = alive;
+            pending = sweeping;
+            pending_alive = alive;
+        }
+        
+        // Nothing left tells the sampled solutions apart
+        if (pick < 0) return false;
+        
+        Constraint c = fact_to_constraint(&facts[indices[pick]], config->width);
+        puzzle->constraints[puzzle->num_constraints++] = c;
+        update_quotas_for_constraint(&c, quotas);
+        alive &= ~best_mask;
+        pending_c = c;
+    }
+}
+
 /**
  * Select constraints to create a uniquely solvable puzzle
  * Uses reusable solver context for efficiency
@@ -460,7 +721,7 @@ static bool would_exceed_quota(const Constraint* c, const ConstraintQuotas* quot
 static bool select_constraints(const GeneratorConfig* config, RNG* rng, 
                               const uint8_t* solution_board, Fact* facts, 
                               int num_facts, Puzzle* puzzle,
-                              SolverContext* solver_ctx) {
+                              SolverContext* solver_ctx, const SolverLimits* limits) {
     // Initialize quota tracking
     ConstraintQuotas quotas = {0, 0, 0};
     
@@ -557,23 +818,40 @@ static bool select_constraints(const GeneratorConfig* config, RNG* rng,
         update_quotas_for_constraint(&c, &quotas);
     }
     
+    if (config->sample_solutions > 0) {
+        return select_by_sampling(config, rng, facts, indices, scores, num_facts,
+                                  &quotas, puzzle, solver_ctx, limits);
+    }
+    
     // PHASE 2: Check if we have unique solution
     solver_precompute_masks(puzzle);
     for (int j = 0; j < total_cells; j++) {
         if (!is_locked(puzzle, j)) puzzle->board[j] = SHAPE_CAT;
     }
     
+    // Every check below goes through one session: the generating board
+    // and each solution found stay known, so an added constraint that
+    // keeps two of them needs no search
+    SolverSession session;
+    solver_session_init(&session, solver_ctx, puzzle);
+    session.limits = limits;
+    solver_session_add_board(&session, solution_board);
+    
     clock_t solve_start = clock();
-    SolverResult result = solver_solve_ex(solver_ctx, puzzle, 2);
+    SolverResult result = solver_session_check(&session);
     clock_t solve_end = clock();
     
     if (g_debug) {
-        g_solver_calls++;
-        g_solver_time_ms += ((double)(solve_end - solve_start) / CLOCKS_PER_SEC) * 1000.0;
+        note_solver_call(solve_start, solve_end);
         printf("    [DEBUG] After %d constraints: %llu solutions\n", 
                puzzle->num_constraints, (unsigned long long)result.solution_count);
     }
     
+    // A search stopped by limits gives the attempt up
+    if (result.status != SOLVE_COMPLETE) {
+        return false;
+    }
+    
     if (result.solution_count == 1) {
         return true;  // Success!
     }
@@ -582,36 +860,26 @@ static bool select_constraints(const GeneratorConfig* config, RNG* rng,
         return false;  // Conflict - try different solution board
     }
     
-    // PHASE 3: Multiple solutions - add more constraints one by one
-    // Continue to enforce quotas during this phase
-    int fact_start = 0;
-    // Find where we left off
-    for (int i = 0; i < num_facts; i++) {
-        Fact* fact = &facts[indices[i]];
-        Constraint c = fact_to_constraint(fact, config->width);
-        if (!is_redundant_or_conflicting(puzzle, &c) && !would_exceed_quota(&c, &quotas, config)) {
-            // This constraint wasn't added yet and won't exceed quotas
-            fact_start = i;
-            break;
-        }
-    }
-    
-    for (int i = fact_start; i < num_facts && puzzle->num_constraints < config->max_constraints; i++) {
-        // Skip facts with negative scores (quota exceeded)
-        if (scores[i] < 0) continue;
-        
-        Fact* fact = &facts[indices[i]];
-        Constraint c = fact_to_constraint(fact, config->width);
-        
-        if (is_redundant_or_conflicting(puzzle, &c)) {
-            continue;
+    // PHASE 3: Multiple solutions - each check that finds two hands back
+    // counterexamples (solutions other than the generating board). Facts
+    // are read off the generating board, so the candidates are the ones a
+    // counterexample fails: every added constraint rules out at least one
+    // known alternative. Quotas and score order still apply within that
+    // set. The first counterexample that some fact rules out is used.
+    SolverResult alternatives = result;
+    
+    while (puzzle->num_constraints < config->max_constraints) {
+        int pick = -1;
+        for (int w = 0; w < alternatives.num_witnesses && pick < 0; w++) {
+            if (memcmp(alternatives.witnesses[w], solution_board, total_cells) == 0) continue;
+            pick = pick_separating_fact(config, puzzle, facts, indices, scores, num_facts,
+                                        &quotas, alternatives.witnesses[w]);
         }
         
-        // Enforce quotas in phase 3 as well
-        if (would_exceed_quota(&c, &quotas, config)) {
-            continue;
-        }
+        // Nothing left rules out a known alternative
+        if (pick < 0) break;
         
+        Constraint c = fact_to_constraint(&facts[indices[pick]], config->width);
         int prev_count = puzzle->num_constraints;
         puzzle->constraints[puzzle->num_constraints++] = c;
         update_quotas_for_constraint(&c, &quotas);
@@ -622,12 +890,15 @@ static bool select_constraints(const GeneratorConfig* config, RNG* rng,
         }
         
         clock_t start = clock();
-        result = solver_solve_ex(solver_ctx, puzzle, 2);
+        result = solver_session_check(&session);
         clock_t end = clock();
         
         if (g_debug) {
-            g_solver_calls++;
-            g_solver_time_ms += ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+            note_solver_call(start, end);
+        }
+        
+        if (result.status != SOLVE_COMPLETE) {
+            return false;
         }
         
         if (result.solution_count == 1) {
@@ -638,8 +909,10 @@ static bool select_constraints(const GeneratorConfig* config, RNG* rng,
             }
             return true;
         } else if (result.solution_count == 0) {
-            // Roll back constraint and quota tracking
+            // Roll back constraint and quota tracking, and don't pick
+            // this fact again (the alternatives are unchanged)
             puzzle->num_constraints = prev_count;
+            scores[pick] = -1;
             // Decrement the appropriate quota counter
             if (c.type == CONSTRAINT_CELL) {
                 if (c.op == OP_IS) {
@@ -650,25 +923,13 @@ static bool select_constraints(const GeneratorConfig* config, RNG* rng,
             } else {
                 quotas.count_constraint_count--;
             }
+        } else {
+            alternatives = result;
         }
     }
     
-    // Final check
-    for (int j = 0; j < total_cells; j++) {
-        if (!is_locked(puzzle, j)) puzzle->board[j] = SHAPE_CAT;
-    }
-    solver_precompute_masks(puzzle);
-    
-    clock_t final_start = clock();
-    result = solver_solve_ex(solver_ctx, puzzle, 2);
-    clock_t final_end = clock();
-    
-    if (g_debug) {
-        g_solver_calls++;
-        g_solver_time_ms += ((double)(final_end - final_start) / CLOCKS_PER_SEC) * 1000.0;
-    }
-    
-    return result.solution_count == 1;
+    // The last check that kept its constraint found more than one solution
+    return false;
 }
 
 /**
@@ -709,151 +970,12 @@ static void add_locked_cells(const GeneratorConfig* config, RNG* rng,
     }
 }
 
-// =============================================================================
-// Parallel Generation Support
-// =============================================================================
-
-typedef struct {
-    const GeneratorConfig* config;
-    uint64_t seed;
-    int attempt_offset;
-    Puzzle result_puzzle;
-    bool success;
-    bool done;
-} WorkerArgs;
-
-// Shared state for parallel workers
-typedef struct {
-    pthread_mutex_t mutex;
-    bool found_solution;
-    Puzzle* result;
-} SharedState;
-
-static SharedState* g_shared_state = NULL;
-
-/**
- * Worker thread function for parallel generation
- */
-static void* generation_worker(void* arg) {
-    WorkerArgs* args = (WorkerArgs*)arg;
-    const GeneratorConfig* config = args->config;
-    
-    // Each worker gets its own RNG with a different seed offset
-    RNG rng;
-    rng_init(&rng, args->seed + args->attempt_offset * 1000);
-    
-    // Each worker gets its own solver context for efficiency
-    SolverContext* solver_ctx = solver_context_create();
-    if (!solver_ctx) {
-        args->success = false;
-        args->done = true;
-        return NULL;
-    }
-    
-    // Initialize puzzle
-    Puzzle puzzle = {0};
-    puzzle.width = config->width;
-    puzzle.height = config->height;
-    
-    // Try multiple solution boards
-    const int MAX_ATTEMPTS = 15;  // Each worker tries this many boards
-    
-    for (int attempt = 0; attempt < MAX_ATTEMPTS; attempt++) {
-        // Check if another worker already found a solution
-        if (g_shared_state) {
-            pthread_mutex_lock(&g_shared_state->mutex);
-            bool already_found = g_shared_state->found_solution;
-            pthread_mutex_unlock(&g_shared_state->mutex);
-            if (already_found) break;
-        }
-        
-        // Generate solution board
-        uint8_t solution_board[MAX_CELLS];
-        generate_solution_board(config, &rng, solution_board);
-        
-        // Reset puzzle
-        puzzle.num_constraints = 0;
-        puzzle.locked_mask = 0;
-        for (int i = 0; i < config->width * config->height; i++) {
-            puzzle.board[i] = SHAPE_CAT;
-        }
-        
-        // Add locked cells
-        add_locked_cells(config, &rng, solution_board, &puzzle);
-        
-        // Extract facts and try to select constraints
-        Fact facts[MAX_FACTS];
-        int num_facts = extract_facts(config, solution_board, facts);
-        
-        bool success = select_constraints(config, &rng, solution_board, facts, 
-                                          num_facts, &puzzle, solver_ctx);
-        
-        if (success) {
-            // Found a valid puzzle!
-            args->result_puzzle = puzzle;
-            args->success = true;
-            
-            // Signal other workers to stop
-            if (g_shared_state) {
-                pthread_mutex_lock(&g_shared_state->mutex);
-                if (!g_shared_state->found_solution) {
-                    g_shared_state->found_solution = true;
-                    *g_shared_state->result = puzzle;
-                }
-                pthread_mutex_unlock(&g_shared_state->mutex);
-            }
-            
-            break;
-        }
-    }
-    
-    solver_context_destroy(solver_ctx);
-    args->done = true;
-    return NULL;
-}
-
-/**
- * Generate puzzle using parallel workers
- */
-static bool generator_generate_parallel(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle) {
-    // Initialize shared state
-    SharedState shared = {
-        .found_solution = false,
-        .result = puzzle
-    };
-    pthread_mutex_init(&shared.mutex, NULL);
-    g_shared_state = &shared;
-    
-    // Create worker threads
-    pthread_t threads[NUM_WORKERS];
-    WorkerArgs args[NUM_WORKERS];
-    
-    for (int i = 0; i < NUM_WORKERS; i++) {
-        args[i] = (WorkerArgs){
-            .config = config,
-            .seed = seed,
-            .attempt_offset = i,
-            .success = false,
-            .done = false
-        };
-        pthread_create(&threads[i], NULL, generation_worker, &args[i]);
-    }
-    
-    // Wait for all workers
-    for (int i = 0; i < NUM_WORKERS; i++) {
-        pthread_join(threads[i], NULL);
-    }
-    
-    g_shared_state = NULL;
-    pthread_mutex_destroy(&shared.mutex);
-    
-    return shared.found_solution;
-}
-
 /**
- * Generate puzzle - single threaded implementation
+ * Generate puzzle - single threaded implementation, on the caller's
+ * solver context
  */
-static bool generator_generate_single(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle) {
+static bool generator_generate_single(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle,
+                                      SolverContext* solver_ctx) {
     RNG rng;
     rng_init(&rng, seed);
     
@@ -862,10 +984,6 @@ static bool generator_generate_single(const GeneratorConfig* config, uint64_t se
     puzzle->width = config->width;
     puzzle->height = config->height;
     
-    // Create reusable solver context
-    SolverContext* solver_ctx = solver_context_create();
-    if (!solver_ctx) return false;
-    
     // Generate solution board
     uint8_t solution_board[MAX_CELLS];
     generate_solution_board(config, &rng, solution_board);
@@ -895,7 +1013,8 @@ static bool generator_generate_single(const GeneratorConfig* config, uint64_t se
     add_locked_cells(config, &rng, solution_board, puzzle);
     
     // Select constraints for unique solution
-    bool success = select_constraints(config, &rng, solution_board, facts, num_facts, puzzle, solver_ctx);
+    bool success = select_constraints(config, &rng, solution_board, facts, num_facts, puzzle,
+                                      solver_ctx, NULL);
     
     if (g_debug) {
         printf("  [DEBUG] First attempt: %s, constraints=%d\n", 
@@ -917,7 +1036,8 @@ static bool generator_generate_single(const GeneratorConfig* config, uint64_t se
             // Add locked cells for this attempt
             add_locked_cells(config, &rng, solution_board, puzzle);
             
-            success = select_constraints(config, &rng, solution_board, facts, num_facts, puzzle, solver_ctx);
+            success = select_constraints(config, &rng, solution_board, facts, num_facts, puzzle,
+                                         solver_ctx, NULL);
             
             if (g_debug) {
                 printf("  [DEBUG] Attempt %d: %s, constraints=%d\n", 
@@ -926,12 +1046,432 @@ static bool generator_generate_single(const GeneratorConfig* config, uint64_t se
         }
     }
     
+    return success;
+}
+
+// =============================================================================
+// Parallel Generation Support
+// =============================================================================
+
+/**
+ * State of one parallel generation call, shared by the pool threads
+ * working on it
+ * 
+ * Attempt a of stream s has index a * GENERATION_STREAMS + s, and the
+ * lowest index that succeeds wins. Each stream's attempts follow from its
+ * own RNG, so the winner depends only on (config, seed), never on thread
+ * timing or count. best_index only ever decreases; a stream stops once
+ * its next attempt could no longer win, and a success cancels the solves
+ * of attempts in flight with a higher index.
+ */
+typedef struct GenerationJob {
+    const GeneratorConfig* config;
+    uint64_t seed;
+    atomic_int best_index;   // Lowest successful attempt index (INT_MAX = none yet)
+    Puzzle results[GENERATION_STREAMS];  // Stream s's puzzle, if it succeeded
+    atomic_int attempt_index[GENERATION_STREAMS];  // Stream s's attempt in flight
+    atomic_bool cancel[GENERATION_STREAMS];        // Stops that attempt's solves
+    
+    // Guarded by the pool lock
+    int next_stream;         // Next stream for a pool thread to claim
+    int streams_done;
+    struct GenerationJob* next;  // Pool queue link
+} GenerationJob;
+
+/**
+ * Per-thread share of a batch's seeds: offsets [head, tail) from
+ * seed_begin. The owner takes from the head; thieves take the back half
+ * from the tail.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t head;
+    uint64_t tail;
+} SeedRange;
+
+/**
+ * One generator_pool_generate_batch() call. Every seed is generated whole
+ * by one pool thread (its streams in order), which gives the same puzzle
+ * as a single-seed call; out[offset] is written by that thread only.
+ */
+typedef struct GenerationBatch {
+    const GeneratorConfig* config;
+    uint64_t seed_begin;
+    Puzzle* out;
+    uint32_t flags;
+    int num_ranges;
+    SeedRange* ranges;       // One per pool thread
+    
+    // Guarded by the pool lock
+    bool queued;             // Still offered to idle pool threads
+    int workers_inside;      // Pool threads taking seeds from it
+    struct GenerationBatch* next;
+} GenerationBatch;
+
+/**
+ * Long-lived generator threads
+ * 
+ * Jobs wait in a FIFO queue until every stream has been claimed. Each
+ * thread claims one stream at a time, so several jobs can be in flight
+ * at once and a job's streams spread over idle threads. Batches wait in
+ * a second queue; a thread with no job to work on joins the first batch
+ * and takes seeds from it until none are left to take or steal.
+ */
+struct GeneratorPool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;  // A job was queued, or shutdown
+    pthread_cond_t job_done;    // Some job finished its last stream
+    GenerationJob* queue_head;
+    GenerationJob* queue_tail;
+    GenerationBatch* batch_head;
+    GenerationBatch* batch_tail;
+    bool shutdown;
+    int num_threads;
+    int next_worker_id;
+    pthread_t threads[GENERATOR_MAX_THREADS];
+};
+
+static void job_init(GenerationJob* job, const GeneratorConfig* config, uint64_t seed) {
+    *job = (GenerationJob){ .config = config, .seed = seed };
+    atomic_init(&job->best_index, INT_MAX);
+    for (int s = 0; s < GENERATION_STREAMS; s++) {
+        atomic_init(&job->attempt_index[s], 0);
+        atomic_init(&job->cancel[s], false);
+    }
+}
+
+/**
+ * Lower best_index to index unless a lower attempt already succeeded, and
+ * cancel the attempts in flight that can no longer win
+ * 
+ * A stream publishes its attempt index before reading best_index, and
+ * this stores best_index before reading attempt indices, so an attempt
+ * either sees the new best and does not start or is seen here and
+ * cancelled.
+ */
+static void publish_success(GenerationJob* job, int index) {
+    int best = atomic_load(&job->best_index);
+    while (index < best && !atomic_compare_exchange_weak(&job->best_index, &best, index)) {
+        // best now holds the current value; retry while ours is lower
+    }
+    
+    for (int s = 0; s < GENERATION_STREAMS; s++) {
+        if (atomic_load(&job->attempt_index[s]) > index) {
+            atomic_store(&job->cancel[s], true);
+        }
+    }
+}
+
+/**
+ * Run the attempts of one stream until one succeeds, a lower attempt
+ * index has already won, or the stream is exhausted
+ */
+static void run_stream(GenerationJob* job, int stream, SolverContext* solver_ctx) {
+    const GeneratorConfig* config = job->config;
+    
+    RNG rng;
+    rng_init(&rng, job->seed + stream * 1000);
+    
+    Puzzle puzzle = {0};
+    puzzle.width = config->width;
+    puzzle.height = config->height;
+    SolverLimits limits = { .cancel = &job->cancel[stream] };
+    
+    for (int attempt = 0; attempt < ATTEMPTS_PER_STREAM; attempt++) {
+        int index = attempt * GENERATION_STREAMS + stream;
+        atomic_store(&job->cancel[stream], false);
+        atomic_store(&job->attempt_index[stream], index);
+        if (atomic_load(&job->best_index) < index) return;
+        
+        // Generate solution board
+        uint8_t solution_board[MAX_CELLS];
+        generate_solution_board(config, &rng, solution_board);
+        
+        // Reset puzzle
+        puzzle.num_constraints = 0;
+        puzzle.locked_mask = 0;
+        for (int i = 0; i < config->width * config->height; i++) {
+            puzzle.board[i] = SHAPE_CAT;
+        }
+        
+        // Add locked cells
+        add_locked_cells(config, &rng, solution_board, &puzzle);
+        
+        // Extract facts and try to select constraints
+        Fact facts[MAX_FACTS];
+        int num_facts = extract_facts(config, solution_board, facts);
+        
+        if (select_constraints(config, &rng, solution_board, facts, num_facts,
+                               &puzzle, solver_ctx, &limits)) {
+            job->results[stream] = puzzle;
+            publish_success(job, index);
+            return;
+        }
+    }
+}
+
+/**
+ * The puzzle of a finished job: that of its lowest successful attempt
+ */
+static bool job_result(GenerationJob* job, Puzzle* puzzle) {
+    int best = atomic_load(&job->best_index);
+    if (best == INT_MAX) {
+        return false;
+    }
+    *puzzle = job->results[best % GENERATION_STREAMS];
+    return true;
+}
+
+/**
+ * Generate one seed entirely on the calling thread, with its solver
+ * context. Same result as generator_generate().
+ */
+static bool generate_on_thread(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle,
+                               SolverContext* solver_ctx) {
+    if (config->width * config->height < 12) {
+        return generator_generate_single(config, seed, puzzle, solver_ctx);
+    }
+    
+    GenerationJob job;
+    job_init(&job, config, seed);
+    for (int stream = 0; stream < GENERATION_STREAMS; stream++) {
+        run_stream(&job, stream, solver_ctx);
+    }
+    return job_result(&job, puzzle);
+}
+
+/**
+ * Generate the seed at offset in a batch; a failed seed is left zeroed
+ */
+static void generate_batch_seed(GenerationBatch* batch, uint64_t offset, SolverContext* solver_ctx) {
+    uint64_t seed = batch->seed_begin + offset;
+    Puzzle* puzzle = &batch->out[offset];
+    
+    if (!generate_on_thread(batch->config, seed, puzzle, solver_ctx)) {
+        memset(puzzle, 0, sizeof(*puzzle));
+    } else if (batch->flags & GENERATOR_BATCH_DISPLAY) {
+        generator_optimize_constraints(puzzle, seed);
+    }
+}
+
+static bool take_seed(GenerationBatch* batch, int id, uint64_t* offset) {
+    SeedRange* own = &batch->ranges[id];
+    
+    pthread_mutex_lock(&own->lock);
+    bool found = own->head < own->tail;
+    if (found) *offset = own->head++;
+    pthread_mutex_unlock(&own->lock);
+    if (found) return true;
+    
+    // Own range is empty: steal half of the first non-empty victim
+    for (int k = 1; k < batch->num_ranges; k++) {
+        SeedRange* victim = &batch->ranges[(id + k) % batch->num_ranges];
+        
+        pthread_mutex_lock(&victim->lock);
+        uint64_t available = victim->tail - victim->head;
+        uint64_t stolen = (available + 1) / 2;
+        victim->tail -= stolen;
+        uint64_t begin = victim->tail;
+        pthread_mutex_unlock(&victim->lock);
+        
+        if (stolen > 0) {
+            *offset = begin;
+            pthread_mutex_lock(&own->lock);
+            own->head = begin + 1;
+            own->tail = begin + stolen;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Pool thread: claims streams from queued jobs, or seeds from queued
+ * batches, until shutdown
+ */
+static void* pool_worker(void* arg) {
+    GeneratorPool* pool = (GeneratorPool*)arg;
+    
+    // One solver context per thread, reused by every job it works on.
+    // If allocation fails, solves fall back to per-call contexts (NULL).
+    SolverContext* solver_ctx = solver_context_create();
+    
+    pthread_mutex_lock(&pool->lock);
+    int id = pool->next_worker_id++;
+    for (;;) {
+        while (!pool->queue_head && !pool->batch_head && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        
+        // Batch work goes one seed at a time, so a job queued meanwhile
+        // waits for at most one seed per thread before it is picked up
+        if (!pool->queue_head && pool->batch_head) {
+            GenerationBatch* batch = pool->batch_head;
+            batch->workers_inside++;
+            pthread_mutex_unlock(&pool->lock);
+            
+            uint64_t offset;
+            bool took = take_seed(batch, id, &offset);
+            if (took) {
+                generate_batch_seed(batch, offset, solver_ctx);
+            }
+            
+            // Nothing left to take: stop offering the batch. Only the
+            // head batch is ever worked on, so a queued one is the head.
+            pthread_mutex_lock(&pool->lock);
+            if (!took && batch->queued) {
+                batch->queued = false;
+                pool->batch_head = batch->next;
+                if (!pool->batch_head) pool->batch_tail = NULL;
+            }
+            if (--batch->workers_inside == 0 && !batch->queued) {
+                pthread_cond_broadcast(&pool->job_done);
+            }
+            continue;
+        }
+        if (!pool->queue_head) break;
+        
+        // Claim the next stream; a job leaves the queue with its last one
+        GenerationJob* job = pool->queue_head;
+        int stream = job->next_stream++;
+        if (job->next_stream == GENERATION_STREAMS) {
+            pool->queue_head = job->next;
+            if (!pool->queue_head) pool->queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+        
+        run_stream(job, stream, solver_ctx);
+        
+        pthread_mutex_lock(&pool->lock);
+        if (++job->streams_done == GENERATION_STREAMS) {
+            pthread_cond_broadcast(&pool->job_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    
     solver_context_destroy(solver_ctx);
+    return NULL;
+}
+
+GeneratorPool* generator_pool_create(int num_threads) {
+    if (num_threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (int)online : 1;
+    }
+    if (num_threads > GENERATOR_MAX_THREADS) num_threads = GENERATOR_MAX_THREADS;
     
-    return success;
+    GeneratorPool* pool = calloc(1, sizeof(GeneratorPool));
+    if (!pool) return NULL;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->job_done, NULL);
+    
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool->threads[pool->num_threads], NULL, pool_worker, pool) == 0) {
+            pool->num_threads++;
+        }
+    }
+    if (pool->num_threads == 0) {
+        generator_pool_destroy(pool);
+        return NULL;
+    }
+    return pool;
 }
 
-bool generator_generate(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle) {
+void generator_pool_destroy(GeneratorPool* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 0; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->job_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+int generator_pool_threads(const GeneratorPool* pool) {
+    return pool ? pool->num_threads : 0;
+}
+
+// Solver context of each thread that generates on itself (small boards,
+// or no pool), created on first use and destroyed when the thread exits
+static pthread_key_t g_thread_ctx_key;
+static pthread_once_t g_thread_ctx_once = PTHREAD_ONCE_INIT;
+
+static void destroy_thread_ctx(void* ctx) {
+    solver_context_destroy(ctx);
+}
+
+static void create_thread_ctx_key(void) {
+    pthread_key_create(&g_thread_ctx_key, destroy_thread_ctx);
+}
+
+/**
+ * The calling thread's cached solver context (NULL if allocation fails,
+ * and solves then use per-call contexts)
+ */
+static SolverContext* thread_solver_context(void) {
+    pthread_once(&g_thread_ctx_once, create_thread_ctx_key);
+    SolverContext* ctx = pthread_getspecific(g_thread_ctx_key);
+    if (!ctx) {
+        ctx = solver_context_create();
+        if (ctx && pthread_setspecific(g_thread_ctx_key, ctx) != 0) {
+            solver_context_destroy(ctx);
+            ctx = NULL;
+        }
+    }
+    return ctx;
+}
+
+/**
+ * Generate puzzle using the pool's threads (or, without a pool, the same
+ * streams in order on the calling thread)
+ */
+static bool generator_generate_parallel(GeneratorPool* pool, const GeneratorConfig* config,
+                                        uint64_t seed, Puzzle* puzzle) {
+    GenerationJob job;
+    job_init(&job, config, seed);
+    
+    if (pool) {
+        pthread_mutex_lock(&pool->lock);
+        if (pool->queue_tail) {
+            pool->queue_tail->next = &job;
+        } else {
+            pool->queue_head = &job;
+        }
+        pool->queue_tail = &job;
+        pthread_cond_broadcast(&pool->work_ready);
+        
+        while (job.streams_done < GENERATION_STREAMS) {
+            pthread_cond_wait(&pool->job_done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    } else {
+        SolverContext* solver_ctx = thread_solver_context();
+        for (int stream = 0; stream < GENERATION_STREAMS; stream++) {
+            run_stream(&job, stream, solver_ctx);
+        }
+    }
+    return job_result(&job, puzzle);
+}
+
+// Pool used by generator_generate(), created on first use
+static GeneratorPool* g_default_pool = NULL;
+static pthread_once_t g_default_pool_once = PTHREAD_ONCE_INIT;
+
+static void create_default_pool(void) {
+    g_default_pool = generator_pool_create(0);
+}
+
+bool generator_pool_generate(GeneratorPool* pool, const GeneratorConfig* config,
+                             uint64_t seed, Puzzle* puzzle) {
     if (!config || !puzzle) return false;
     if (config->width > MAX_WIDTH || config->height > MAX_HEIGHT) return false;
     
@@ -939,10 +1479,85 @@ bool generator_generate(const GeneratorConfig* config, uint64_t seed, Puzzle* pu
     bool use_parallel = (config->width * config->height >= 12);
     
     if (use_parallel) {
-        return generator_generate_parallel(config, seed, puzzle);
+        return generator_generate_parallel(pool, config, seed, puzzle);
+    }
+    
+    // Too small to be worth handing to the pool: run on this thread's
+    // warm context
+    return generator_generate_single(config, seed, puzzle, thread_solver_context());
+}
+
+size_t generator_pool_generate_batch(GeneratorPool* pool, const GeneratorConfig* config,
+                                     uint64_t seed_begin, uint64_t seed_end, Puzzle* out,
+                                     uint32_t flags) {
+    if (!config || !out || seed_end <= seed_begin) return 0;
+    uint64_t count = seed_end - seed_begin;
+    
+    if (config->width > MAX_WIDTH || config->height > MAX_HEIGHT) {
+        memset(out, 0, count * sizeof(Puzzle));
+        return 0;
+    }
+    
+    GenerationBatch batch = {
+        .config = config,
+        .seed_begin = seed_begin,
+        .out = out,
+        .flags = flags,
+        .num_ranges = pool ? pool->num_threads : 0,
+    };
+    batch.ranges = pool ? malloc(batch.num_ranges * sizeof(SeedRange)) : NULL;
+    
+    if (batch.ranges) {
+        // Contiguous shares to start with; stealing evens out the rest
+        for (int i = 0; i < batch.num_ranges; i++) {
+            pthread_mutex_init(&batch.ranges[i].lock, NULL);
+            batch.ranges[i].head = count * i / batch.num_ranges;
+            batch.ranges[i].tail = count * (i + 1) / batch.num_ranges;
+        }
+        
+        pthread_mutex_lock(&pool->lock);
+        batch.queued = true;
+        if (pool->batch_tail) {
+            pool->batch_tail->next = &batch;
+        } else {
+            pool->batch_head = &batch;
+        }
+        pool->batch_tail = &batch;
+        pthread_cond_broadcast(&pool->work_ready);
+        
+        while (batch.queued || batch.workers_inside > 0) {
+            pthread_cond_wait(&pool->job_done, &pool->lock);
+        }
+        pthread_mutex_unlock(&pool->lock);
+        
+        for (int i = 0; i < batch.num_ranges; i++) {
+            pthread_mutex_destroy(&batch.ranges[i].lock);
+        }
+        free(batch.ranges);
     } else {
-        return generator_generate_single(config, seed, puzzle);
+        // No pool (or no memory for one): every seed on this thread
+        SolverContext* solver_ctx = thread_solver_context();
+        for (uint64_t offset = 0; offset < count; offset++) {
+            generate_batch_seed(&batch, offset, solver_ctx);
+        }
+    }
+    
+    size_t generated = 0;
+    for (uint64_t offset = 0; offset < count; offset++) {
+        generated += (out[offset].width != 0);
     }
+    return generated;
+}
+
+size_t generator_generate_batch(const GeneratorConfig* config, uint64_t seed_begin,
+                                uint64_t seed_end, Puzzle* out, uint32_t flags) {
+    pthread_once(&g_default_pool_once, create_default_pool);
+    return generator_pool_generate_batch(g_default_pool, config, seed_begin, seed_end, out, flags);
+}
+
+bool generator_generate(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle) {
+    pthread_once(&g_default_pool_once, create_default_pool);
+    return generator_pool_generate(g_default_pool, config, seed, puzzle);
 }
 
 bool generator_quick(Difficulty level, uint64_t seed, Puzzle* puzzle) {
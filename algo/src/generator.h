@@ -34,8 +34,16 @@ typedef struct {
     int max_cell_is;         // Max "cell = shape" direct assignments (0 = none allowed)
     int max_cell_is_not_cat; // Max "cell ≠ cat" constraints (1 = allow one per puzzle)
     int min_count_constraints; // Min row/col/global count constraints required
+    
+    // Information-gain ranking: past the first batch of constraints, sample
+    // up to this many solutions of the partial puzzle and add the fact that
+    // rules out the most of them (0 = static scores only, the default;
+    // at most GENERATOR_MAX_SAMPLES)
+    int sample_solutions;
 } GeneratorConfig;
 
+#define GENERATOR_MAX_SAMPLES 64
+
 /**
  * Get default configuration for a difficulty level
  */
@@ -43,6 +51,8 @@ GeneratorConfig generator_default_config(Difficulty level);
 
 /**
  * Generate a puzzle with the given configuration and seed
+ * Uses a shared default pool, started on first use with one thread per
+ * online CPU and kept until the process exits.
  * 
  * @param config  Generator configuration
  * @param seed    Random seed for reproducibility
@@ -51,6 +61,61 @@ GeneratorConfig generator_default_config(Difficulty level);
  */
 bool generator_generate(const GeneratorConfig* config, uint64_t seed, Puzzle* puzzle);
 
+/**
+ * Persistent generator worker pool
+ * 
+ * Each thread keeps its own solver context between puzzles. Puzzles of 12
+ * or more cells are generated on a pool (smaller ones on the calling
+ * thread); several threads may generate on the same pool at once. The
+ * puzzle for a given (config, seed) does not depend on the pool or its
+ * size.
+ */
+#define GENERATOR_MAX_THREADS 256
+typedef struct GeneratorPool GeneratorPool;
+
+/**
+ * Start a pool of num_threads threads (<= 0: one per online CPU)
+ * Returns NULL if no thread could be started.
+ */
+GeneratorPool* generator_pool_create(int num_threads);
+
+/**
+ * Stop and join the pool's threads (no generation may be in progress)
+ */
+void generator_pool_destroy(GeneratorPool* pool);
+
+int generator_pool_threads(const GeneratorPool* pool);
+
+/**
+ * Same as generator_generate(), on the given pool (NULL: calling thread only)
+ */
+bool generator_pool_generate(GeneratorPool* pool, const GeneratorConfig* config,
+                             uint64_t seed, Puzzle* puzzle);
+
+/**
+ * Generate the puzzles for seeds [seed_begin, seed_end) into out, one per
+ * seed in seed order, each identical to generator_generate() for its seed
+ * 
+ * Seeds are spread over the pool's threads with work stealing (per-seed
+ * cost varies widely), and each thread reuses its own solver context. A
+ * seed that fails to generate leaves its puzzle zeroed (width 0).
+ * 
+ * @param out    seed_end - seed_begin puzzles
+ * @param flags  GENERATOR_BATCH_* bits
+ * @return       Number of puzzles generated
+ */
+#define GENERATOR_BATCH_DISPLAY 0x1u  // Also fill display constraints
+                                      // (generator_optimize_constraints with the seed)
+size_t generator_pool_generate_batch(GeneratorPool* pool, const GeneratorConfig* config,
+                                     uint64_t seed_begin, uint64_t seed_end, Puzzle* out,
+                                     uint32_t flags);
+
+/**
+ * Batch generation on the default pool (see generator_generate())
+ */
+size_t generator_generate_batch(const GeneratorConfig* config, uint64_t seed_begin,
+                                uint64_t seed_end, Puzzle* out, uint32_t flags);
+
 /**
  * Quick generate with difficulty and seed only
  */
@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
 
 #include "types.h"
 #include "solver.h"
@@ -25,6 +26,139 @@
 #define COLOR_CYAN   "\x1b[36m"
 #define COLOR_RESET  "\x1b[0m"
 
+/**
+ * Solution visitor for the enumeration test: validates each board and
+ * keeps the first two
+ */
+typedef struct {
+    const Puzzle* puzzle;
+    uint64_t stop_after;  // 0 = visit all
+    uint64_t visited;
+    int invalid;
+    uint8_t first[2][MAX_CELLS];
+} EnumerateCheck;
+
+static bool check_solution(const uint8_t* board, void* user) {
+    EnumerateCheck* check = (EnumerateCheck*)user;
+    int total = check->puzzle->width * check->puzzle->height;
+    
+    Puzzle candidate = *check->puzzle;
+    memcpy(candidate.board, board, total);
+    if (!solver_validate(&candidate)) check->invalid++;
+    
+    if (check->visited < 2) memcpy(check->first[check->visited], board, total);
+    check->visited++;
+    return check->stop_after == 0 || check->visited < check->stop_after;
+}
+
+/**
+ * Generation job for the reentrancy test: a few consecutive seeds
+ */
+#define GENERATE_JOB_SEEDS 4
+typedef struct {
+    Difficulty level;
+    uint64_t first_seed;
+    bool ok[GENERATE_JOB_SEEDS];
+    Puzzle puzzles[GENERATE_JOB_SEEDS];
+} GenerateJob;
+
+static void* run_generate_job(void* arg) {
+    GenerateJob* job = (GenerateJob*)arg;
+    for (int i = 0; i < GENERATE_JOB_SEEDS; i++) {
+        job->ok[i] = generator_quick(job->level, job->first_seed + i, &job->puzzles[i]);
+    }
+    return NULL;
+}
+
+static bool same_puzzle(const Puzzle* a, const Puzzle* b) {
+    if (a->width != b->width || a->height != b->height || a->locked_mask != b->locked_mask ||
+        a->num_constraints != b->num_constraints ||
+        memcmp(a->board, b->board, a->width * a->height) != 0) {
+        return false;
+    }
+    for (int i = 0; i < a->num_constraints; i++) {
+        const Constraint* x = &a->constraints[i];
+        const Constraint* y = &b->constraints[i];
+        if (x->type != y->type || x->op != y->op || x->shape != y->shape ||
+            x->count != y->count || x->index != y->index ||
+            x->cell_x != y->cell_x || x->cell_y != y->cell_y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Seeded random puzzles for the solver cross-checks, independent of the
+ * generator. The index picks the board (2x2 up to 4x4) and how many
+ * constraints it gets (none up to 30), so the corpus runs from wide open
+ * puzzles to unique ones. A few cells are locked. The constraints hold
+ * for a hidden board, counting the way the solver does (a Cat counts
+ * towards every shape), except that every fourth puzzle ends with one
+ * that is off by one and may have no solution.
+ */
+#define CORPUS_PUZZLES 80
+
+static void corpus_puzzle(int index, Puzzle* p) {
+    static const int sizes[][2] = { {2, 2}, {2, 3}, {3, 3}, {3, 4}, {4, 4} };
+    RNG rng;
+    rng_init(&rng, 5000 + index);
+    
+    // A zeroed board is all Cats
+    memset(p, 0, sizeof(*p));
+    p->width = sizes[index % 5][0];
+    p->height = sizes[index % 5][1];
+    int total = p->width * p->height;
+    
+    uint8_t hidden[MAX_CELLS];
+    uint64_t matches[SHAPE_COUNT] = {0};
+    for (int i = 0; i < total; i++) {
+        hidden[i] = (uint8_t)rng_int(&rng, SHAPE_COUNT);
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            if (hidden[i] == s || hidden[i] == SHAPE_CAT) matches[s] |= 1ULL << i;
+        }
+        if (rng_int(&rng, 8) == 0) {
+            p->board[i] = hidden[i];
+            set_locked(p, i, true);
+        }
+    }
+    
+    int num_constraints = (index / 5) * 2;
+    while (p->num_constraints < num_constraints) {
+        Constraint c = { .type = rng_int(&rng, 4), .shape = rng_int(&rng, SHAPE_COUNT) };
+        if (c.type == CONSTRAINT_CELL) {
+            c.cell_x = rng_int(&rng, p->width);
+            c.cell_y = rng_int(&rng, p->height);
+        } else {
+            c.index = rng_int(&rng, c.type == CONSTRAINT_ROW ? p->height : p->width);
+        }
+        
+        int count = __builtin_popcountll(solver_constraint_mask(&c, p->width, p->height) &
+                                         matches[c.shape]);
+        if (c.type == CONSTRAINT_CELL) {
+            c.op = count ? OP_IS : OP_IS_NOT;
+        } else {
+            int op = rng_int(&rng, 4);
+            c.op = (op == 1) ? OP_AT_LEAST : (op == 2) ? OP_AT_MOST : OP_EXACTLY;
+            c.count = count;
+        }
+        p->constraints[p->num_constraints++] = c;
+    }
+    
+    // Off by one: flip a cell constraint, or move a count out of range
+    if (index % 4 == 3 && p->num_constraints > 0) {
+        Constraint* c = &p->constraints[p->num_constraints - 1];
+        if (c->type == CONSTRAINT_CELL) {
+            c->op = (c->op == OP_IS) ? OP_IS_NOT : OP_IS;
+        } else if (c->op == OP_AT_LEAST || c->count == 0) {
+            c->op = OP_AT_LEAST;
+            c->count++;
+        } else {
+            c->count--;
+        }
+    }
+}
+
 /**
  * Test the solver with known puzzles
  */
@@ -368,47 +502,801 @@ static int run_tests(void) {
         }
     }
     
+    // Test 12: Branching order does not change solution counts
+    {
+        printf("Test 12: Static and most-constrained ordering agree... ");
+        
+        SolverContext* static_ctx = solver_context_create();
+        SolverContext* mcv_ctx = solver_context_create();
+        solver_context_set_ordering(mcv_ctx, SOLVER_ORDER_MOST_CONSTRAINED);
+        
+        int mismatches = 0;
+        int checked = 0;
+        for (uint64_t seed = 0; seed < 20; seed++) {
+            Puzzle p;
+            if (!generator_quick(LEVEL_4, seed, &p)) continue;
+            
+            // Drop half the constraints so there are many solutions to count
+            p.num_constraints /= 2;
+            
+            SolverResult a = solver_solve_ex(static_ctx, &p, 0, NULL);
+            SolverResult b = solver_solve_ex(mcv_ctx, &p, 0, NULL);
+            if (a.solution_count != b.solution_count) mismatches++;
+            checked++;
+        }
+        
+        solver_context_destroy(static_ctx);
+        solver_context_destroy(mcv_ctx);
+        
+        if (mismatches == 0 && checked > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", checked);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched)\n", mismatches, checked);
+            failed++;
+        }
+    }
+    
+    // Test 13: Interleaved stepwise solves match one-shot solves
+    {
+        printf("Test 13: Interleaved solver_step() matches solver_solve_ex()... ");
+        
+        enum { NUM_SOLVES = 8 };
+        Puzzle puzzles[NUM_SOLVES];
+        SolverContext* contexts[NUM_SOLVES];
+        uint64_t expected[NUM_SOLVES];
+        int mismatches = 0;
+        
+        for (int i = 0; i < NUM_SOLVES; i++) {
+            uint64_t seed = 100 + i;
+            while (!generator_quick(LEVEL_4, seed, &puzzles[i])) seed += NUM_SOLVES;
+            puzzles[i].num_constraints /= 2;
+            expected[i] = solver_solve_ex(NULL, &puzzles[i], 0, NULL).solution_count;
+            
+            contexts[i] = solver_context_create();
+            solver_begin(contexts[i], &puzzles[i], 0, NULL);
+        }
+        
+        // Round-robin a few nodes at a time until every solve is done
+        bool all_done = false;
+        while (!all_done) {
+            all_done = true;
+            for (int i = 0; i < NUM_SOLVES; i++) {
+                if (!solver_step(contexts[i], 3)) all_done = false;
+            }
+        }
+        
+        for (int i = 0; i < NUM_SOLVES; i++) {
+            if (solver_get_result(contexts[i]).solution_count != expected[i]) mismatches++;
+            solver_context_destroy(contexts[i]);
+        }
+        
+        if (mismatches == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched)\n", mismatches, NUM_SOLVES);
+            failed++;
+        }
+    }
+    
+    // Test 14: Budgets and cancellation stop a solve with a distinct status
+    {
+        printf("Test 14: State budget and cancel flag stop the solver... ");
+        
+        Puzzle p;
+        uint64_t seed = 200;
+        while (!generator_quick(LEVEL_5, seed, &p)) seed++;
+        p.num_constraints = 1;  // Leave plenty of search to interrupt
+        
+        SolverLimits budget = { .max_states = 10 };
+        SolverResult limited = solver_solve_ex(NULL, &p, 0, &budget);
+        
+        atomic_bool cancel = true;
+        SolverLimits cancelled = { .cancel = &cancel };
+        SolverResult stopped = solver_solve_ex(NULL, &p, 0, &cancelled);
+        
+        SolverResult full = solver_solve_ex(NULL, &p, 0, NULL);
+        
+        if (limited.status == SOLVE_BUDGET_EXHAUSTED && limited.states_explored <= 10 &&
+            stopped.status == SOLVE_CANCELLED && full.status == SOLVE_COMPLETE) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET "\n");
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (statuses %d/%d/%d)\n",
+                   limited.status, stopped.status, full.status);
+            failed++;
+        }
+    }
+    
+    // Test 15: Parallel counting matches the serial count
+    {
+        printf("Test 15: Parallel solution count matches serial count... ");
+        
+        int mismatches = 0;
+        int checked = 0;
+        for (uint64_t seed = 300; seed < 310; seed++) {
+            Puzzle p;
+            if (!generator_quick(LEVEL_5, seed, &p)) continue;
+            p.num_constraints /= 3;
+            
+            uint64_t serial = solver_count_solutions(&p);
+            for (int depth = 0; depth <= 3; depth++) {
+                SolverResult parallel = solver_count_solutions_parallel(&p, 4, depth);
+                if (parallel.solution_count != serial) mismatches++;
+            }
+            checked++;
+        }
+        
+        if (mismatches == 0 && checked > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", checked);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatches)\n", mismatches);
+            failed++;
+        }
+    }
+    
+    // Test 16: Enumeration visits valid solutions and matches the witnesses
+    {
+        printf("Test 16: solver_enumerate() visits every solution... ");
+        
+        Puzzle p;
+        uint64_t seed = 400;
+        while (!generator_quick(LEVEL_3, seed, &p)) seed++;
+        p.num_constraints /= 2;
+        
+        EnumerateCheck check = { .puzzle = &p, .stop_after = 0 };
+        SolverResult all = solver_enumerate(NULL, &p, check_solution, &check, NULL);
+        uint64_t expected = solver_count_solutions(&p);
+        
+        EnumerateCheck stopped = { .puzzle = &p, .stop_after = 3 };
+        solver_enumerate(NULL, &p, check_solution, &stopped, NULL);
+        
+        SolverResult two = solver_solve_ex(NULL, &p, 2, NULL);
+        int total = p.width * p.height;
+        bool witnesses_match = two.num_witnesses == 2 &&
+            memcmp(two.witnesses[0], check.first[0], total) == 0 &&
+            memcmp(two.witnesses[1], check.first[1], total) == 0;
+        
+        if (check.invalid == 0 && check.visited == expected && all.solution_count == expected &&
+            stopped.visited == 3 && witnesses_match) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%llu solutions)\n", (unsigned long long)expected);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (visited %llu of %llu, %d invalid)\n",
+                   (unsigned long long)check.visited, (unsigned long long)expected, check.invalid);
+            failed++;
+        }
+    }
+    
+    // Test 17: Batch validation agrees with solver_validate()
+    {
+        printf("Test 17: Batch validator matches solver_validate()... ");
+        
+        Puzzle p;
+        uint64_t seed = 500;
+        while (!generator_quick(LEVEL_4, seed, &p)) seed++;
+        SolverResult solved = solver_solve_ex(NULL, &p, 1, NULL);
+        
+        // Mutations of the solution (some stay valid) plus random boards
+        enum { NUM_BOARDS = 4096 };
+        static uint8_t boards[NUM_BOARDS][MAX_CELLS];
+        bool valid[NUM_BOARDS];
+        int total = p.width * p.height;
+        RNG rng;
+        rng_init(&rng, 500);
+        
+        for (int b = 0; b < NUM_BOARDS; b++) {
+            memcpy(boards[b], solved.witnesses[0], MAX_CELLS);
+            int changes = (b % 2) ? rng_int(&rng, 3) : total;
+            for (int k = 0; k < changes; k++) {
+                boards[b][rng_int(&rng, total)] = rng_int(&rng, SHAPE_COUNT);
+            }
+        }
+        
+        size_t num_valid = solver_validate_batch(&p, boards, NUM_BOARDS, valid);
+        
+        int mismatches = 0;
+        size_t expected_valid = 0;
+        for (int b = 0; b < NUM_BOARDS; b++) {
+            Puzzle candidate = p;
+            memcpy(candidate.board, boards[b], MAX_CELLS);
+            bool expected = solver_validate(&candidate);
+            if (expected != valid[b]) mismatches++;
+            expected_valid += expected;
+        }
+        
+        if (mismatches == 0 && num_valid == expected_valid && expected_valid > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%zu/%d valid)\n", num_valid, NUM_BOARDS);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatches)\n", mismatches);
+            failed++;
+        }
+    }
+    
+    // Test 18: Row-profile DP counter agrees with the backtracker
+    {
+        printf("Test 18: DP model counter matches backtracking counts... ");
+        
+        int mismatches = 0;
+        for (int i = 0; i < CORPUS_PUZZLES; i++) {
+            Puzzle p;
+            corpus_puzzle(i, &p);
+            
+            SolverCount dp_count;
+            uint64_t expected = solver_count_solutions(&p);
+            if (!solver_count_solutions_dp(&p, &dp_count) || dp_count != (SolverCount)expected) {
+                mismatches++;
+            }
+        }
+        
+        // An empty 6x6 board has 4^36 solutions, beyond 64-bit counts
+        Puzzle empty = { .width = MAX_WIDTH, .height = MAX_HEIGHT };
+        SolverCount empty_count = 0;
+        bool wide_ok = solver_count_solutions_dp(&empty, &empty_count) &&
+                       empty_count == (SolverCount)1 << 72;
+        
+        if (mismatches == 0 && wide_ok) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", CORPUS_PUZZLES);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched%s)\n",
+                   mismatches, CORPUS_PUZZLES, wide_ok ? "" : ", 6x6 empty board wrong");
+            failed++;
+        }
+    }
+    
+    // Test 19: Row-pattern engine agrees with the cell engine
+    {
+        printf("Test 19: Row engine matches cell engine counts and witnesses... ");
+        
+        SolverContext* cells_ctx = solver_context_create();
+        SolverContext* rows_ctx = solver_context_create();
+        solver_context_set_engine(rows_ctx, SOLVER_ENGINE_ROWS);
+        
+        int mismatches = 0;
+        int invalid = 0;
+        for (int i = 0; i < CORPUS_PUZZLES; i++) {
+            Puzzle p;
+            corpus_puzzle(i, &p);
+            
+            SolverResult cells = solver_solve_ex(cells_ctx, &p, 0, NULL);
+            SolverResult rows = solver_solve_ex(rows_ctx, &p, 0, NULL);
+            SolverResult two = solver_solve_ex(rows_ctx, &p, 2, NULL);
+            
+            uint64_t expected_two = cells.solution_count < 2 ? cells.solution_count : 2;
+            if (rows.solution_count != cells.solution_count ||
+                two.solution_count != expected_two || two.num_witnesses != expected_two) {
+                mismatches++;
+            }
+            
+            EnumerateCheck check = { .puzzle = &p };
+            for (int w = 0; w < two.num_witnesses; w++) {
+                check_solution(two.witnesses[w], &check);
+            }
+            invalid += check.invalid;
+        }
+        
+        solver_context_destroy(cells_ctx);
+        solver_context_destroy(rows_ctx);
+        
+        if (mismatches == 0 && invalid == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", CORPUS_PUZZLES);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched, %d invalid witnesses)\n",
+                   mismatches, CORPUS_PUZZLES, invalid);
+            failed++;
+        }
+    }
+    
+    // Test 20: Backjumping and learned nogoods keep decision solves exact
+    {
+        printf("Test 20: Uniqueness checks agree with full counts... ");
+        
+        // One context per ordering, reused so learned state must not leak
+        // between solves
+        SolverContext* contexts[2] = { solver_context_create(), solver_context_create() };
+        solver_context_set_ordering(contexts[1], SOLVER_ORDER_MOST_CONSTRAINED);
+        
+        int mismatches = 0;
+        for (int i = 0; i < CORPUS_PUZZLES; i++) {
+            Puzzle p;
+            corpus_puzzle(i, &p);
+            
+            uint64_t expected = solver_count_solutions(&p);
+            uint64_t capped = expected < 2 ? expected : 2;
+            for (int c = 0; c < 2; c++) {
+                SolverResult two = solver_solve_ex(contexts[c], &p, 2, NULL);
+                EnumerateCheck check = { .puzzle = &p };
+                for (int w = 0; w < two.num_witnesses; w++) {
+                    check_solution(two.witnesses[w], &check);
+                }
+                if (two.solution_count != capped || check.invalid > 0) {
+                    mismatches++;
+                }
+            }
+        }
+        
+        solver_context_destroy(contexts[0]);
+        solver_context_destroy(contexts[1]);
+        
+        if (mismatches == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", CORPUS_PUZZLES);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatched of %d)\n",
+                   mismatches, CORPUS_PUZZLES * 2);
+            failed++;
+        }
+    }
+    
+    // Test 21: Incremental session agrees with fresh solves
+    {
+        printf("Test 21: Uniqueness session matches fresh solves... ");
+        
+        SolverContext* ctx = solver_context_create();
+        int mismatches = 0;
+        int checked = 0;
+        uint64_t shortcuts = 0;
+        
+        for (int level = LEVEL_2; level <= LEVEL_5; level++) {
+            for (uint64_t seed = 0; seed < 4; seed++) {
+                Puzzle p;
+                if (!generator_quick(level, 900 + seed, &p)) continue;
+                
+                // Re-add the constraints one at a time, dropping each
+                // again once in a while
+                int total_constraints = p.num_constraints;
+                SolverSession session;
+                solver_session_init(&session, ctx, &p);
+                
+                for (int n = 0; n <= total_constraints; n++) {
+                    for (int undo = 0; undo <= (n % 3 == 2); undo++) {
+                        p.num_constraints = n - undo;
+                        SolverResult fresh = solver_solve_ex(NULL, &p, 2, NULL);
+                        SolverResult result = solver_session_check(&session);
+                        
+                        EnumerateCheck check = { .puzzle = &p };
+                        for (int w = 0; w < result.num_witnesses; w++) {
+                            check_solution(result.witnesses[w], &check);
+                        }
+                        if (result.solution_count != fresh.solution_count || check.invalid > 0 ||
+                            (result.num_witnesses == 2 &&
+                             memcmp(result.witnesses[0], result.witnesses[1], MAX_CELLS) == 0)) {
+                            mismatches++;
+                        }
+                        checked++;
+                    }
+                }
+                shortcuts += session.shortcuts;
+            }
+        }
+        solver_context_destroy(ctx);
+        
+        if (mismatches == 0 && checked > 0 && shortcuts > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d checks, %llu without search)\n",
+                   checked, (unsigned long long)shortcuts);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched, %llu shortcuts)\n",
+                   mismatches, checked, (unsigned long long)shortcuts);
+            failed++;
+        }
+    }
+    
+    // Test 22: Cat count constraints prune on decided cats
+    {
+        printf("Test 22: Cat count constraints match DP counts... ");
+        
+        // A 4x4 board with one locked Cat, every other cell open, under a
+        // global Cat count plus per-row and per-column Cat bounds
+        int mismatches = 0;
+        int checked = 0;
+        for (int cats = 0; cats <= 4; cats++) {
+            for (int op = OP_EXACTLY; op <= OP_AT_MOST; op++) {
+                // A zeroed board is all Cats; only cell 5 is locked
+                Puzzle p = { .width = 4, .height = 4, .locked_mask = 1ULL << 5 };
+                
+                p.constraints[p.num_constraints++] = (Constraint){
+                    .type = CONSTRAINT_GLOBAL, .op = OP_EXACTLY, .shape = SHAPE_CAT, .count = cats };
+                for (int k = 0; k < 4; k++) {
+                    p.constraints[p.num_constraints++] = (Constraint){
+                        .type = (k & 1) ? CONSTRAINT_COLUMN : CONSTRAINT_ROW,
+                        .op = op, .shape = SHAPE_CAT, .count = 1, .index = k };
+                }
+                
+                SolverCount dp_count;
+                SolverResult result = solver_solve_ex(NULL, &p, 0, NULL);
+                if (!solver_count_solutions_dp(&p, &dp_count) ||
+                    dp_count != (SolverCount)result.solution_count) {
+                    mismatches++;
+                }
+                checked++;
+            }
+        }
+        
+        if (mismatches == 0 && checked > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", checked);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d/%d mismatched)\n", mismatches, checked);
+            failed++;
+        }
+    }
+    
+    // Test 23: Root probing keeps counts exact
+    {
+        printf("Test 23: Root probing matches unprobed solves... ");
+        
+        SolverContext* plain_ctx = solver_context_create();
+        SolverContext* probe_ctx = solver_context_create();
+        solver_context_set_probing(probe_ctx, 50.0);
+        
+        int mismatches = 0;
+        uint64_t plain_states = 0;
+        uint64_t probe_states = 0;
+        for (int i = 0; i < CORPUS_PUZZLES; i++) {
+            Puzzle p;
+            corpus_puzzle(i, &p);
+            
+            for (uint64_t max = 0; max <= 2; max += 2) {
+                SolverResult plain = solver_solve_ex(plain_ctx, &p, max, NULL);
+                SolverResult probed = solver_solve_ex(probe_ctx, &p, max, NULL);
+                
+                EnumerateCheck check = { .puzzle = &p };
+                for (int w = 0; w < probed.num_witnesses; w++) {
+                    check_solution(probed.witnesses[w], &check);
+                }
+                if (probed.solution_count != plain.solution_count || check.invalid > 0) {
+                    mismatches++;
+                }
+                plain_states += plain.states_explored;
+                probe_states += probed.states_explored;
+            }
+        }
+        
+        solver_context_destroy(plain_ctx);
+        solver_context_destroy(probe_ctx);
+        
+        if (mismatches == 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles, %llu -> %llu states)\n",
+                   CORPUS_PUZZLES, (unsigned long long)plain_states,
+                   (unsigned long long)probe_states);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatched of %d)\n",
+                   mismatches, CORPUS_PUZZLES * 2);
+            failed++;
+        }
+    }
+        
+        // Test 24: Overlapping constraints are merged before search
+    {
+        printf("Test 24: Presolve merges overlapping constraints... ");
+        
+        // Row 1 at least 1 Circle and exactly 2 Circles, plus a vacuous
+        // "at most 3 Circles" on the same row
+        Puzzle p = { .width = 3, .height = 3 };
+        p.constraints[0] = (Constraint){
+            .type = CONSTRAINT_ROW, .op = OP_AT_LEAST, .shape = SHAPE_CIRCLE, .count = 1, .index = 1 };
+        p.constraints[1] = (Constraint){
+            .type = CONSTRAINT_ROW, .op = OP_EXACTLY, .shape = SHAPE_CIRCLE, .count = 2, .index = 1 };
+        p.constraints[2] = (Constraint){
+            .type = CONSTRAINT_ROW, .op = OP_AT_MOST, .shape = SHAPE_CIRCLE, .count = 3, .index = 1 };
+        p.constraints[3] = (Constraint){
+            .type = CONSTRAINT_GLOBAL, .op = OP_AT_MOST, .shape = SHAPE_CAT, .count = 2 };
+        p.num_constraints = 4;
+        
+        SolverCount dp_count;
+        SolverResult merged = solver_solve_ex(NULL, &p, 0, NULL);
+        bool counts_ok = solver_count_solutions_dp(&p, &dp_count) &&
+                         dp_count == (SolverCount)merged.solution_count && merged.solution_count > 0;
+        
+        // An empty interval is refuted before any state is explored
+        p.constraints[2].count = 1;
+        SolverResult empty = solver_solve_ex(NULL, &p, 0, NULL);
+        bool empty_ok = empty.solution_count == 0 && empty.states_explored == 0;
+        
+        if (counts_ok && empty_ok) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%llu solutions)\n",
+                   (unsigned long long)merged.solution_count);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%llu solutions, empty interval %s)\n",
+                   (unsigned long long)merged.solution_count, empty_ok ? "ok" : "not refuted");
+            failed++;
+        }
+    }
+    
+    // Test 25: Parallel generation is seed-stable and reentrant
+    {
+        printf("Test 25: Concurrent generation matches serial generation... ");
+        
+        // The same seeds on two threads at once, then on this thread
+        GenerateJob jobs[3];
+        for (int j = 0; j < 3; j++) {
+            jobs[j] = (GenerateJob){ .level = LEVEL_4, .first_seed = 1100 };
+        }
+        pthread_t threads[2];
+        int started = 0;
+        for (int j = 0; j < 2; j++) {
+            if (pthread_create(&threads[j], NULL, run_generate_job, &jobs[j]) == 0) started++;
+        }
+        for (int j = 0; j < started; j++) {
+            pthread_join(threads[j], NULL);
+        }
+        run_generate_job(&jobs[2]);
+        
+        int mismatches = 0;
+        for (int j = 0; j < started; j++) {
+            for (int i = 0; i < GENERATE_JOB_SEEDS; i++) {
+                if (jobs[j].ok[i] != jobs[2].ok[i] ||
+                    (jobs[2].ok[i] && !same_puzzle(&jobs[j].puzzles[i], &jobs[2].puzzles[i]))) {
+                    mismatches++;
+                }
+            }
+        }
+        
+        if (mismatches == 0 && started == 2) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d seeds x 3 runs)\n", GENERATE_JOB_SEEDS);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatched, %d threads started)\n",
+                   mismatches, started);
+            failed++;
+        }
+    }
+    
+    // Test 26: Generator pools of any size give the same puzzles
+    {
+        printf("Test 26: Generator pool size does not change puzzles... ");
+        
+        GeneratorPool* pools[3] = { NULL, generator_pool_create(1), generator_pool_create(3) };
+        int mismatches = 0;
+        int checked = 0;
+        for (int level = LEVEL_3; level <= LEVEL_5; level++) {
+            GeneratorConfig config = generator_default_config(level);
+            for (uint64_t seed = 1200; seed < 1204; seed++) {
+                Puzzle expected;
+                bool expected_ok = generator_generate(&config, seed, &expected);
+                for (int k = 0; k < 3; k++) {
+                    Puzzle p;
+                    bool ok = generator_pool_generate(pools[k], &config, seed, &p);
+                    if (ok != expected_ok || (ok && !same_puzzle(&p, &expected))) {
+                        mismatches++;
+                    }
+                }
+                checked++;
+            }
+        }
+        bool pools_ok = generator_pool_threads(pools[1]) == 1 && generator_pool_threads(pools[2]) == 3;
+        generator_pool_destroy(pools[1]);
+        generator_pool_destroy(pools[2]);
+        
+        if (mismatches == 0 && pools_ok) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d seeds x 4 pools)\n", checked);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatched of %d)\n", mismatches, checked * 3);
+            failed++;
+        }
+    }
+    
+    // Test 27: Batch generation matches single-seed generation
+    {
+        printf("Test 27: Batch generation matches per-seed generation... ");
+        
+        enum { BATCH_SEEDS = 12 };
+        GeneratorPool* pool = generator_pool_create(3);
+        int mismatches = 0;
+        int checked = 0;
+        for (int level = LEVEL_1; level <= LEVEL_5; level += 2) {
+            GeneratorConfig config = generator_default_config(level);
+            Puzzle pooled[BATCH_SEEDS];
+            Puzzle serial[BATCH_SEEDS];
+            size_t pooled_count = generator_pool_generate_batch(pool, &config, 1300, 1300 + BATCH_SEEDS,
+                                                                pooled, GENERATOR_BATCH_DISPLAY);
+            size_t serial_count = generator_pool_generate_batch(NULL, &config, 1300, 1300 + BATCH_SEEDS,
+                                                                serial, 0);
+            mismatches += (pooled_count != serial_count);
+            
+            for (int i = 0; i < BATCH_SEEDS; i++) {
+                Puzzle expected;
+                bool ok = generator_generate(&config, 1300 + i, &expected);
+                if (ok) generator_optimize_constraints(&expected, 1300 + i);
+                
+                if (ok != (pooled[i].width != 0) || ok != (serial[i].width != 0) ||
+                    (ok && (!same_puzzle(&pooled[i], &expected) || !same_puzzle(&serial[i], &expected) ||
+                            pooled[i].num_display_constraints != expected.num_display_constraints))) {
+                    mismatches++;
+                }
+                checked++;
+            }
+        }
+        generator_pool_destroy(pool);
+        
+        if (mismatches == 0 && checked > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d seeds)\n", checked);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d mismatched of %d)\n", mismatches, checked);
+            failed++;
+        }
+    }
+    
+    // Test 28: Sampled fact ranking generates unique, reproducible puzzles
+    {
+        printf("Test 28: Sampled fact ranking gives unique puzzles... ");
+        
+        int bad = 0;
+        int generated = 0;
+        for (int level = LEVEL_1; level <= LEVEL_5; level++) {
+            GeneratorConfig config = generator_default_config(level);
+            config.sample_solutions = 16;
+            
+            for (uint64_t seed = 1400; seed < 1410; seed++) {
+                Puzzle first, second;
+                bool ok = generator_generate(&config, seed, &first);
+                if (ok != generator_pool_generate(NULL, &config, seed, &second) ||
+                    (ok && !same_puzzle(&first, &second))) {
+                    bad++;
+                }
+                if (!ok) continue;
+                
+                generated++;
+                if (!solver_has_unique_solution(&first) ||
+                    first.num_constraints > config.max_constraints) {
+                    bad++;
+                }
+            }
+        }
+        
+        if (bad == 0 && generated > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d puzzles)\n", generated);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d bad of %d)\n", bad, generated);
+            failed++;
+        }
+    }
+    
+    // Test 29: Every phase-3 constraint rules out a solution of the puzzle before it
+    {
+        printf("Test 29: Phase-3 constraints each rule out a solution... ");
+        
+        // A constraint fails some solution of the constraints before it
+        // exactly when adding it lowers the count. Phase 3 starts once
+        // phase 1 has added min_constraints plus a board-size bonus.
+        int bad = 0;
+        int checked = 0;
+        int generated = 0;
+        for (int level = LEVEL_3; level <= LEVEL_5; level++) {
+            GeneratorConfig config = generator_default_config(level);
+            int cells = config.width * config.height;
+            int phase3 = config.min_constraints + (cells >= 12 ? 8 : cells >= 9 ? 4 : 2);
+            if (phase3 > config.max_constraints) phase3 = config.max_constraints;
+            
+            for (uint64_t seed = 1500; seed < 1510; seed++) {
+                Puzzle p;
+                if (!generator_generate(&config, seed, &p)) continue;
+                
+                generated++;
+                if (!solver_has_unique_solution(&p)) bad++;
+                
+                Puzzle prefix = p;
+                prefix.num_constraints = phase3 < p.num_constraints ? phase3 : p.num_constraints;
+                uint64_t before = solver_count_solutions(&prefix);
+                while (prefix.num_constraints < p.num_constraints) {
+                    prefix.num_constraints++;
+                    uint64_t after = solver_count_solutions(&prefix);
+                    if (after >= before) bad++;
+                    before = after;
+                    checked++;
+                }
+            }
+        }
+        
+        if (bad == 0 && checked > 0) {
+            printf(COLOR_GREEN "PASS" COLOR_RESET " (%d constraints in %d puzzles)\n",
+                   checked, generated);
+            passed++;
+        } else {
+            printf(COLOR_RED "FAIL" COLOR_RESET " (%d bad of %d)\n", bad, checked);
+            failed++;
+        }
+    }
+    
     printf("\n" COLOR_CYAN "Results: %d passed, %d failed" COLOR_RESET "\n\n", passed, failed);
     
     return failed > 0 ? 1 : 0;
 }
 
+/**
+ * Measure batch board validation throughput on random boards
+ */
+static void benchmark_validation(const GeneratorConfig* config) {
+    Puzzle p;
+    if (!generator_generate(config, 0, &p)) return;
+    
+    enum { NUM_BOARDS = 1 << 16, ROUNDS = 32 };
+    static uint8_t boards[NUM_BOARDS][MAX_CELLS];
+    RNG rng;
+    rng_init(&rng, 0);
+    for (int b = 0; b < NUM_BOARDS; b++) {
+        for (int i = 0; i < p.width * p.height; i++) {
+            boards[b][i] = rng_int(&rng, SHAPE_COUNT);
+        }
+    }
+    
+    size_t num_valid = 0;
+    clock_t start = clock();
+    for (int r = 0; r < ROUNDS; r++) {
+        num_valid += solver_validate_batch(&p, boards, NUM_BOARDS, NULL);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    
+    printf("  Validation:   %.1f M boards/s (%zu valid)\n",
+           seconds > 0 ? (double)NUM_BOARDS * ROUNDS / seconds / 1e6 : 0.0, num_valid);
+}
+
 /**
  * Run performance benchmark for a single level
+ * Puzzles are generated on the pool and counted on count_threads threads.
  */
-static void run_benchmark(Difficulty level) {
+static void run_benchmark(Difficulty level, SolverOrdering ordering, SolverEngine engine,
+                          double probe_ms, int sample_solutions, GeneratorPool* pool,
+                          int count_threads) {
+    static const char* ENGINE_NAMES[] = { "cells", "rows", "auto" };
     GeneratorConfig config = generator_default_config(level);
+    config.sample_solutions = sample_solutions;
     
     printf("\n" COLOR_CYAN "=== Benchmark Level %d (%dx%d) ===" COLOR_RESET "\n\n", 
            level, config.width, config.height);
+    printf("  Ordering:     %s\n",
+           ordering == SOLVER_ORDER_MOST_CONSTRAINED ? "most-constrained" : "static");
+    printf("  Engine:       %s\n", ENGINE_NAMES[engine]);
+    printf("  Probing:      %s\n", probe_ms > 0 ? "on" : "off");
+    printf("  Fact ranking: %s\n", sample_solutions > 0 ? "sampled" : "static");
+    // Parallel counting splits the cell engine's static search and takes
+    // no context settings, so any other engine, ordering or probing
+    // counts serially on ctx
+    bool parallel = count_threads > 1 && engine == SOLVER_ENGINE_CELLS &&
+                    ordering == SOLVER_ORDER_STATIC && probe_ms <= 0;
+    printf("  Threads:      %d generating, %d counting\n\n",
+           generator_pool_threads(pool), parallel ? count_threads : 1);
+    
+    SolverContext* ctx = solver_context_create();
+    solver_context_set_ordering(ctx, ordering);
+    solver_context_set_engine(ctx, engine);
+    solver_context_set_probing(ctx, probe_ms);
     
-    const int ITERATIONS = 50;
+    enum { ITERATIONS = 50 };
     
-    double total_gen_time = 0;
     double total_solve_time = 0;
     uint64_t total_states = 0;
     int unique_count = 0;
-    int generated = 0;
     
-    clock_t start = clock();
+    double start = solver_now_ms();
+    
+    // Generate every seed up front, spread over the pool
+    static Puzzle puzzles[ITERATIONS];
+    int generated = (int)generator_pool_generate_batch(pool, &config, 0, ITERATIONS, puzzles, 0);
+    double total_gen_time = solver_now_ms() - start;
     
     for (int seed = 0; seed < ITERATIONS; seed++) {
-        Puzzle p;
-        
-        clock_t gen_start = clock();
-        bool success = generator_generate(&config, seed, &p);
-        clock_t gen_end = clock();
-        
-        if (!success) {
+        Puzzle* p = &puzzles[seed];
+        if (p->width == 0) {
             printf("  Seed %d: generation failed\n", seed);
             continue;
         }
-        generated++;
-        
-        total_gen_time += ((double)(gen_end - gen_start) / CLOCKS_PER_SEC) * 1000.0;
         
         // Count solutions
-        SolverResult result = solver_solve(&p, false);
+        SolverResult result = parallel ?
+            solver_count_solutions_parallel(p, count_threads, 0) :
+            solver_solve_ex(ctx, p, 0, NULL);
         total_solve_time += result.time_ms;
         total_states += result.states_explored;
         
@@ -418,9 +1306,9 @@ static void run_benchmark(Difficulty level) {
             printf("  Seed %d: %llu solutions\n", seed, (unsigned long long)result.solution_count);
         }
     }
+    double total_time = solver_now_ms() - start;
     
-    clock_t end = clock();
-    double total_time = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    solver_context_destroy(ctx);
     
     printf("\nResults:\n");
     printf("  Generated:    %d/%d puzzles\n", generated, ITERATIONS);
@@ -429,7 +1317,10 @@ static void run_benchmark(Difficulty level) {
     printf("  Avg gen time: %.3f ms\n", generated > 0 ? total_gen_time / generated : 0);
     printf("  Avg solve:    %.3f ms\n", generated > 0 ? total_solve_time / generated : 0);
     printf("  Avg states:   %llu\n", generated > 0 ? (unsigned long long)(total_states / generated) : 0);
-    printf("  Total time:   %.1f ms\n\n", total_time);
+    printf("  Total time:   %.1f ms\n", total_time);
+    
+    benchmark_validation(&config);
+    printf("\n");
 }
 
 /**
@@ -464,6 +1355,8 @@ static void solve_puzzle(Difficulty level, uint64_t seed) {
     printf("\nResults:\n");
     printf("  Solutions:    %lu\n", (unsigned long)result.solution_count);
     printf("  States:       %lu\n", (unsigned long)result.states_explored);
+    printf("  Cache:        %lu hits / %lu misses\n",
+           (unsigned long)result.cache_hits, (unsigned long)result.cache_misses);
     printf("  Time:         %.3f ms\n", result.time_ms);
     printf("  Raw constraints:     %d\n", p.num_constraints);
     printf("  Display constraints: %d\n", p.num_display_constraints);
@@ -476,11 +1369,12 @@ static void solve_puzzle(Difficulty level, uint64_t seed) {
 /**
  * Profile a single puzzle generation with detailed timing
  */
-static void profile_generation(Difficulty level, uint64_t seed) {
+static void profile_generation(Difficulty level, uint64_t seed, int sample_solutions) {
     printf("\n" COLOR_CYAN "=== Profiling Single Generation ===" COLOR_RESET "\n");
     printf("Level: %d, Seed: %lu\n\n", level, (unsigned long)seed);
     
     GeneratorConfig config = generator_default_config(level);
+    config.sample_solutions = sample_solutions;
     printf("Config: %dx%d board, %d-%d constraints, %d cats, %d locked\n\n",
            config.width, config.height,
            config.min_constraints, config.max_constraints,
@@ -523,11 +1417,16 @@ static void profile_generation(Difficulty level, uint64_t seed) {
         
         printf("  Solutions:    %lu\n", (unsigned long)result.solution_count);
         printf("  States:       %lu\n", (unsigned long)result.states_explored);
+        printf("  Cache:        %lu hits / %lu misses\n",
+               (unsigned long)result.cache_hits, (unsigned long)result.cache_misses);
         printf("  Solve Time:   %.3f ms\n", result.time_ms);
     }
     
     printf("\n" COLOR_YELLOW "Analysis:" COLOR_RESET "\n");
-    printf("  select_constraints() calls solver_solve_ex() after EVERY constraint.\n");
+    printf("  select_constraints() checks uniqueness after every constraint it adds past\n");
+    printf("  the first batch, each chosen to rule out a solution the last check found\n");
+    printf("  (through a solver session, which skips the search while two known\n");
+    printf("  solutions hold).\n");
     printf("  For Level 5, this happens %d times across multiple solution board attempts.\n", 
            solver_calls);
     printf("  Total solver time: %.1f ms = %.1f%% of generation time.\n",
@@ -537,34 +1436,50 @@ static void profile_generation(Difficulty level, uint64_t seed) {
 /**
  * Batch generate and validate puzzles
  */
-static void batch_validate(Difficulty level, int count) {
+static void batch_validate(Difficulty level, int count, int sample_solutions,
+                           GeneratorPool* pool) {
     printf("\n" COLOR_CYAN "=== Batch Validation ===" COLOR_RESET "\n");
-    printf("Level: %d, Count: %d\n\n", level, count);
+    printf("Level: %d, Count: %d, Threads: %d\n\n", level, count, generator_pool_threads(pool));
     
+    GeneratorConfig config = generator_default_config(level);
+    config.sample_solutions = sample_solutions;
     int unique = 0;
     int multiple = 0;
     int unsolvable = 0;
     int gen_failed = 0;
     
     double total_time = 0;
+    double gen_time = 0;
     
-    for (int seed = 0; seed < count; seed++) {
-        Puzzle p;
-        if (!generator_quick(level, seed, &p)) {
-            gen_failed++;
-            continue;
-        }
+    // Generate in chunks of seeds, each spread over the pool
+    enum { CHUNK = 256 };
+    static Puzzle puzzles[CHUNK];
+    
+    for (int chunk_begin = 0; chunk_begin < count; chunk_begin += CHUNK) {
+        int chunk_end = (count - chunk_begin < CHUNK) ? count : chunk_begin + CHUNK;
         
-        SolverResult result = solver_solve(&p, false);
-        total_time += result.time_ms;
+        double gen_start = solver_now_ms();
+        generator_pool_generate_batch(pool, &config, chunk_begin, chunk_end, puzzles, 0);
+        gen_time += solver_now_ms() - gen_start;
         
-        if (result.solution_count == 1) {
-            unique++;
-        } else if (result.solution_count > 1) {
-            multiple++;
-            printf("  Seed %d: %lu solutions\n", seed, (unsigned long)result.solution_count);
-        } else {
-            unsolvable++;
+        for (int seed = chunk_begin; seed < chunk_end; seed++) {
+            Puzzle* p = &puzzles[seed - chunk_begin];
+            if (p->width == 0) {
+                gen_failed++;
+                continue;
+            }
+            
+            SolverResult result = solver_solve(p, false);
+            total_time += result.time_ms;
+            
+            if (result.solution_count == 1) {
+                unique++;
+            } else if (result.solution_count > 1) {
+                multiple++;
+                printf("  Seed %d: %lu solutions\n", seed, (unsigned long)result.solution_count);
+            } else {
+                unsolvable++;
+            }
         }
     }
     
@@ -573,6 +1488,7 @@ static void batch_validate(Difficulty level, int count) {
     printf("  Unique:       " COLOR_GREEN "%d" COLOR_RESET "\n", unique);
     printf("  Multiple:     " COLOR_YELLOW "%d" COLOR_RESET "\n", multiple);
     printf("  Unsolvable:   " COLOR_RED "%d" COLOR_RESET "\n", unsolvable);
+    printf("  Gen time:     %.1f ms (%.3f ms avg)\n", gen_time, count > 0 ? gen_time / count : 0);
     printf("  Total time:   %.1f ms (%.3f ms avg)\n", total_time, total_time / count);
 }
 
@@ -590,6 +1506,14 @@ static void print_usage(const char* prog) {
     printf("  --level N           Set difficulty level (1-5, default: 3)\n");
     printf("  --seed S            Set random seed (default: time-based)\n");
     printf("  --count C           Number of puzzles for batch mode (default: 100)\n");
+    printf("  --ordering O        Benchmark branching order: static, mcv (default: static)\n");
+    printf("  --engine E          Benchmark search engine: cells, rows, auto (default: cells)\n");
+    printf("  --probe MS          Benchmark root probing time limit per solve (default: off)\n");
+    printf("  --sample N          Rank facts by how many of N sampled solutions they rule\n");
+    printf("                      out (benchmark/profile/batch generation; default: off)\n");
+    printf("  --threads T         Worker threads for batch/benchmark generation (default: one\n");
+    printf("                      per online CPU); when given, also benchmark counting\n");
+    printf("                      threads (default cells engine, static order, no probing)\n");
     printf("  --help              Show this help\n");
 }
 
@@ -603,6 +1527,12 @@ int main(int argc, char* argv[]) {
     Difficulty level = LEVEL_3;
     uint64_t seed = (uint64_t)time(NULL);
     int count = 100;
+    SolverOrdering ordering = SOLVER_ORDER_STATIC;
+    SolverEngine engine = SOLVER_ENGINE_CELLS;
+    double probe_ms = 0;
+    int sample_solutions = 0;
+    int num_threads = 0;  // One per online CPU
+    bool threads_given = false;
     
     // Parse arguments
     for (int i = 1; i < argc; i++) {
@@ -623,6 +1553,23 @@ int main(int argc, char* argv[]) {
             seed = strtoull(argv[++i], NULL, 10);
         } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
             count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+            if (num_threads < 0) num_threads = 0;
+            threads_given = true;
+        } else if (strcmp(argv[i], "--ordering") == 0 && i + 1 < argc) {
+            i++;
+            ordering = (strcmp(argv[i], "mcv") == 0) ? SOLVER_ORDER_MOST_CONSTRAINED
+                                                     : SOLVER_ORDER_STATIC;
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            i++;
+            engine = (strcmp(argv[i], "rows") == 0) ? SOLVER_ENGINE_ROWS :
+                     (strcmp(argv[i], "auto") == 0) ? SOLVER_ENGINE_AUTO : SOLVER_ENGINE_CELLS;
+        } else if (strcmp(argv[i], "--probe") == 0 && i + 1 < argc) {
+            probe_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sample") == 0 && i + 1 < argc) {
+            sample_solutions = atoi(argv[++i]);
+            if (sample_solutions < 0) sample_solutions = 0;
         } else if (strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
@@ -641,8 +1588,12 @@ int main(int argc, char* argv[]) {
         exit_code = run_tests();
     }
     
+    GeneratorPool* pool = (do_benchmark || do_batch) ? generator_pool_create(num_threads) : NULL;
+    
     if (do_benchmark) {
-        run_benchmark(level);
+        // Counting stays serial unless --threads asks otherwise
+        run_benchmark(level, ordering, engine, probe_ms, sample_solutions, pool,
+                      threads_given ? generator_pool_threads(pool) : 1);
     }
     
     if (do_solve) {
@@ -650,13 +1601,14 @@ int main(int argc, char* argv[]) {
     }
     
     if (do_profile) {
-        profile_generation(level, seed);
+        profile_generation(level, seed, sample_solutions);
     }
     
     if (do_batch) {
-        batch_validate(level, count);
+        batch_validate(level, count, sample_solutions, pool);
     }
     
+    generator_pool_destroy(pool);
     return exit_code;
 }
 
@@ -2,29 +2,78 @@
  * Schrödinger's Shapes - High Performance Solver Implementation
  * 
  * Core optimizations:
- * 1. Flat uint8_t board - cache-friendly, minimal memory
- * 2. Pre-computed cell masks per constraint - O(1) region iteration
+ * 1. Bitboard state - one uint64_t occupancy plane per shape
+ * 2. Pre-computed cell masks per constraint - region counts are one popcount
  * 3. Incremental constraint checking - only check affected constraints
  * 4. State hashing with zobrist-style keys for duplicate detection
+ *    (counting mode also memoizes exact subtree solution counts)
  * 5. Shape ordering: concrete shapes first for faster pruning
  * 6. Reusable solver context - avoids repeated malloc/free
  * 7. Early exit at max_solutions - don't count beyond what's needed
  * 8. Enhanced bounds checking for count constraints
  */
 
+#define _POSIX_C_SOURCE 199309L  // clock_gettime(CLOCK_MONOTONIC)
+
 #include "solver.h"
+#include <assert.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * Transposition table for pruning explored states
+ * 
+ * Entries are packed into 8 bytes and grouped into 64-byte buckets (one
+ * cache line per probe). Every entry carries the generation it was written
+ * in, so invalidating the whole table between solves is a counter bump
+ * rather than a memset.
+ * 
+ * Entry layout (LSB first):
+ *   [0..7]   generation (0 = never written)
+ *   [8..9]   flags
+ *   [10..15] replacement weight (log2 of the subtree size it summarises)
+ *   [16..63] tag (top 48 bits of the Zobrist hash)
+ */
+#define TT_BUCKET_ENTRIES 8
+#define TT_DEFAULT_BYTES  (1u << 20)  // 1 MB = 131072 entries
+
+#define TT_GEN_BITS     8
+#define TT_FLAG_SHIFT   8
+#define TT_WEIGHT_SHIFT 10
+#define TT_TAG_SHIFT    16
 
-// State cache for pruning explored states
-#define CACHE_SIZE 131072  // Power of 2 for fast modulo
-#define CACHE_MASK (CACHE_SIZE - 1)
+#define TT_GEN_MASK     ((1ULL << TT_GEN_BITS) - 1)
+#define TT_WEIGHT_MASK  0x3FULL
+#define TT_FLAG_NO_SOLUTION (1ULL << TT_FLAG_SHIFT)
 
 typedef struct {
-    uint64_t hash;
-    bool valid;
-} CacheEntry;
+    _Alignas(64) uint64_t entries[TT_BUCKET_ENTRIES];
+} TTBucket;
+
+/**
+ * Count memo for counting mode (max_solutions == 0)
+ * 
+ * Maps a residual-subproblem key to its exact number of completions.
+ * Shares the transposition table's generation stamp, so it is invalidated
+ * by the same O(1) reset. value = count << 8 | generation.
+ */
+#define MEMO_BUCKET_ENTRIES 4
+#define MEMO_MAX_COUNT      (UINT64_MAX >> TT_GEN_BITS)
+
+typedef struct {
+    uint64_t key;
+    uint64_t value;
+} MemoEntry;
+
+typedef struct {
+    _Alignas(64) MemoEntry entries[MEMO_BUCKET_ENTRIES];
+} MemoBucket;
 
 // Domain: bitmask of possible shapes for each cell (computed once at start)
 #define DOMAIN_CAT      (1 << SHAPE_CAT)
@@ -34,6 +83,79 @@ typedef struct {
 #define DOMAIN_ALL      (DOMAIN_CAT | DOMAIN_SQUARE | DOMAIN_CIRCLE | DOMAIN_TRIANGLE)
 #define DOMAIN_CONCRETE (DOMAIN_SQUARE | DOMAIN_CIRCLE | DOMAIN_TRIANGLE)
 
+/**
+ * Running counts for every constraint region (64 bytes, cheap to snapshot):
+ * committed[i] = decided cells that count toward constraint i (its shape,
+ *                or a decided Cat, which counts toward every shape)
+ * open[i]      = undecided cells in constraint i's region
+ * The final count always lies in [committed, committed + open].
+ */
+typedef struct {
+    _Alignas(32) uint8_t committed[MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t open[MAX_CONSTRAINTS];
+} ConstraintCounters;
+
+// The AVX2 paths hold one byte lane per constraint in a single register
+_Static_assert(MAX_CONSTRAINTS == 32, "SIMD counter checks assume 32 constraint lanes");
+
+/**
+ * Trail entry: one domain change, recorded so it can be undone.
+ * shape is TRAIL_DOMAIN_ONLY for a plain domain reduction, otherwise the
+ * shape the cell was assigned (the cell also left the open mask).
+ * A cell's domain can shrink at most SHAPE_COUNT times on one path,
+ * which bounds the trail length.
+ */
+#define TRAIL_DOMAIN_ONLY 0xFF
+
+typedef struct {
+    uint64_t old_reason;
+    uint8_t cell;
+    uint8_t old_domain;
+    uint8_t shape;
+} TrailEntry;
+
+/**
+ * Learned nogood: a combination of decisions that has no solutions.
+ * It applies once every cell in cells is decided, each as the shape s
+ * with its bit in shapes[s].
+ */
+#define NOGOOD_SLOTS        64
+#define NOGOOD_MAX_LITERALS 4
+
+typedef struct {
+    uint64_t cells;
+    uint64_t shapes[SHAPE_COUNT];
+} Nogood;
+
+/**
+ * Everything needed to return to a search node: the trail height plus
+ * the cheap-to-copy state that is restored wholesale
+ */
+typedef struct {
+    int trail_len;
+    uint64_t hash;
+    ConstraintCounters counters;
+} Checkpoint;
+
+/**
+ * One level of the explicit search stack: the cell being branched on,
+ * which shapes remain, and the bookkeeping finished when it is popped.
+ * conflicts collects the decision levels that its failed children (and
+ * the pruning of its cell's domain) depend on.
+ */
+typedef struct {
+    Checkpoint cp;
+    uint64_t conflicts;
+    uint64_t domain_reason;
+    uint64_t states_before;
+    uint64_t count_before;
+    uint64_t memo_key;
+    uint64_t node_key;
+    uint8_t cell;
+    uint8_t domain;
+    uint8_t next;       // Index into BRANCH_ORDER of the next shape to try
+} SearchFrame;
+
 // Solver context (reusable across multiple solves)
 struct SolverContext {
     Puzzle* puzzle;
@@ -41,15 +163,107 @@ struct SolverContext {
     uint64_t max_solutions;
     uint64_t states_explored;
     bool found_solution;
+    SolverOrdering ordering;
+    SolverEngine engine;
+    double probe_ms;  // Root probing time limit (0 = no probing)
+    
+    // Solution boards: the first few are kept as witnesses, and every
+    // one is passed to the enumeration callback (if any) via
+    // solution_board
+    uint8_t num_witnesses;
+    uint8_t witnesses[SOLVER_MAX_WITNESSES][MAX_CELLS];
+    uint8_t solution_board[MAX_CELLS];
+    SolverSolutionCallback callback;
+    void* callback_user;
+    
+    // Bitboard state: planes[s] has bit i set when cell i holds shape s.
+    // Puzzle.board is only read to load these and never written.
+    uint64_t planes[SHAPE_COUNT];
+    
+    // Running per-constraint counts, updated on every assignment
+    ConstraintCounters counters;
+    
+    // Constraints compiled to structure-of-arrays form, one lane per
+    // distinct (region, shape) pair (see compile_lanes). Lanes past
+    // num_lanes are neutral: no cells, bounds [0, 255], so they never
+    // fail a check.
+    int num_lanes;
+    uint64_t masks[MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t shapes[MAX_CONSTRAINTS];
+    
+    // Interval [count_lo, count_hi] each constraint's final count must hit.
+    // A branch is dead once committed > count_hi or committed + open <
+    // count_lo; decided cats are tracked apart from open cells, so this
+    // holds for Cat constraints as well.
+    _Alignas(32) uint8_t count_lo[MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t count_hi[MAX_CONSTRAINTS];
+    
+    // Byte-lane forms of the adjacency index and shape column, for
+    // updating all counters of a cell at once:
+    // cell_lanes[c][i] = 1 if constraint i covers cell c
+    // shape_lanes[s][i] = 1 if constraint i counts shape s (every
+    //                     constraint counts Cat)
+    _Alignas(32) uint8_t cell_lanes[MAX_CELLS][MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t shape_lanes[SHAPE_COUNT][MAX_CONSTRAINTS];
+    
+    // Search state beyond the planes:
+    // open       = cells not yet decided (Cat in the planes, not locked)
+    // domains[s] = bit i set while shape s is still possible for cell i
+    // hash       = Zobrist hash of the planes, maintained incrementally
+    uint64_t open;
+    uint64_t domains[SHAPE_COUNT];
+    uint64_t hash;
+    
+    // Trail of domain changes and assignments, undone on backtrack
+    TrailEntry trail[MAX_CELLS * SHAPE_COUNT];
+    int trail_len;
+    
+    // Conflict analysis. Decision levels are stack indices, one bit each:
+    // reasons[c] = levels that cell c's current domain follows from
+    // conflict   = levels behind the most recent failure
+    uint64_t reasons[MAX_CELLS];
+    uint64_t conflict;
+    
+    // Small learned nogoods (bounded, oldest replaced first)
+    Nogood nogoods[NOGOOD_SLOTS];
+    int num_nogoods;
+    int next_nogood;
+    
+    // Explicit search stack (one frame per branching cell), so a solve
+    // can be paused between nodes and resumed with solver_step()
+    SearchFrame stack[MAX_CELLS];
+    int depth;
+    bool descend;     // The current state is a node still to be entered
+    SolveStatus status;
+    double time_ms;   // Accumulated over solver_step() calls
+    
+    // Bounds for the current solve (max_states is UINT64_MAX when unset)
+    SolverLimits limits;
+    
+    // Adjacency index: bit i of cell_constraints[c] is set when
+    // lane i covers cell c
+    uint32_t cell_constraints[MAX_CELLS];
+    
+    // Transposition table (see TTBucket)
+    TTBucket* tt;
+    uint64_t tt_bucket_mask;  // num_buckets - 1 (power of 2)
+    uint8_t tt_generation;    // Current generation, never 0
+    uint64_t tt_hits;
+    uint64_t tt_misses;
     
-    // State cache
-    CacheEntry* cache;
+    // Count memo (same bucket count as the transposition table)
+    MemoBucket* memo;
+    
+    // Row engine workspace (see solver_solve_rows_in), on first use
+    void* rows;
     
     // Pre-computed zobrist keys for hashing
     uint64_t zobrist[MAX_CELLS][SHAPE_COUNT];
     
-    // Domain tracking: possible shapes for each cell (computed once per solve)
-    uint8_t domains[MAX_CELLS];
+    // Keys for residual-subproblem hashing: lane i with decided
+    // contribution d mixes in residual_keys[i][d]
+    uint64_t residual_keys[MAX_CONSTRAINTS][MAX_CELLS + 1];
+    
 };
 
 // Initialize zobrist keys (deterministic for reproducibility)
@@ -64,17 +278,45 @@ static void init_zobrist(SolverContext* ctx) {
             ctx->zobrist[i][s] = seed * 0x2545F4914F6CDD1DULL;
         }
     }
+    for (int i = 0; i < MAX_CONSTRAINTS; i++) {
+        for (int d = 0; d <= MAX_CELLS; d++) {
+            seed ^= seed >> 12;
+            seed ^= seed << 25;
+            seed ^= seed >> 27;
+            ctx->residual_keys[i][d] = seed * 0x2545F4914F6CDD1DULL;
+        }
+    }
 }
 
 SolverContext* solver_context_create(void) {
-    SolverContext* ctx = calloc(1, sizeof(SolverContext));
+    return solver_context_create_sized(TT_DEFAULT_BYTES);
+}
+
+SolverContext* solver_context_create_sized(size_t cache_bytes) {
+    // Over-aligned for the SIMD constraint lanes
+    size_t ctx_bytes = (sizeof(SolverContext) + 63) & ~(size_t)63;
+    SolverContext* ctx = aligned_alloc(64, ctx_bytes);
     if (!ctx) return NULL;
+    memset(ctx, 0, ctx_bytes);
+    
+    // Round down to a power-of-two number of buckets (at least one)
+    size_t num_buckets = 1;
+    while (num_buckets * 2 * sizeof(TTBucket) <= cache_bytes) {
+        num_buckets *= 2;
+    }
     
-    ctx->cache = calloc(CACHE_SIZE, sizeof(CacheEntry));
-    if (!ctx->cache) {
+    ctx->tt = aligned_alloc(sizeof(TTBucket), num_buckets * sizeof(TTBucket));
+    ctx->memo = aligned_alloc(sizeof(MemoBucket), num_buckets * sizeof(MemoBucket));
+    if (!ctx->tt || !ctx->memo) {
+        free(ctx->tt);
+        free(ctx->memo);
         free(ctx);
         return NULL;
     }
+    memset(ctx->tt, 0, num_buckets * sizeof(TTBucket));
+    memset(ctx->memo, 0, num_buckets * sizeof(MemoBucket));
+    ctx->tt_bucket_mask = num_buckets - 1;
+    ctx->tt_generation = 1;
     
     init_zobrist(ctx);
     return ctx;
@@ -82,139 +324,235 @@ SolverContext* solver_context_create(void) {
 
 void solver_context_destroy(SolverContext* ctx) {
     if (ctx) {
-        free(ctx->cache);
+        free(ctx->tt);
+        free(ctx->memo);
+        free(ctx->rows);
         free(ctx);
     }
 }
 
+void solver_context_set_ordering(SolverContext* ctx, SolverOrdering ordering) {
+    if (ctx) {
+        ctx->ordering = ordering;
+    }
+}
+
+void solver_context_set_engine(SolverContext* ctx, SolverEngine engine) {
+    if (ctx) {
+        ctx->engine = engine;
+    }
+}
+
+void solver_context_set_probing(SolverContext* ctx, double time_limit_ms) {
+    if (ctx) {
+        ctx->probe_ms = time_limit_ms > 0 ? time_limit_ms : 0;
+    }
+}
+
+/**
+ * Clear the per-search results, keeping the cache and memo tables
+ */
+static void reset_search_stats(SolverContext* ctx) {
+    ctx->tt_hits = 0;
+    ctx->tt_misses = 0;
+    ctx->solution_count = 0;
+    ctx->states_explored = 0;
+    ctx->found_solution = false;
+    ctx->num_witnesses = 0;
+    ctx->callback = NULL;
+}
+
 void solver_context_reset(SolverContext* ctx) {
     if (ctx) {
-        memset(ctx->cache, 0, CACHE_SIZE * sizeof(CacheEntry));
-        ctx->solution_count = 0;
-        ctx->states_explored = 0;
-        ctx->found_solution = false;
+        // Entries from older generations read as empty. Only when the
+        // 8-bit generation wraps does the table need a real clear.
+        if (++ctx->tt_generation == 0) {
+            memset(ctx->tt, 0, (ctx->tt_bucket_mask + 1) * sizeof(TTBucket));
+            memset(ctx->memo, 0, (ctx->tt_bucket_mask + 1) * sizeof(MemoBucket));
+            ctx->tt_generation = 1;
+        }
+        reset_search_stats(ctx);
+    }
+}
+
+/**
+ * Load bitboard planes from a flat board
+ */
+static inline void load_planes(uint64_t* planes, const uint8_t* board, int total) {
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        planes[s] = 0;
+    }
+    for (int i = 0; i < total; i++) {
+        planes[board[i]] |= (1ULL << i);
+    }
+}
+
+/**
+ * Write bitboard planes back out as a flat board
+ */
+static inline void store_planes(const uint64_t* planes, uint8_t* board, int total) {
+    memset(board, SHAPE_CAT, total);
+    for (int s = SHAPE_SQUARE; s < SHAPE_COUNT; s++) {
+        uint64_t cells = planes[s];
+        while (cells) {
+            board[__builtin_ctzll(cells)] = s;
+            cells &= cells - 1;
+        }
     }
 }
 
-// Compute board hash
+// splitmix64 finalizer, used to key cell masks
+static inline uint64_t mix64(uint64_t k) {
+    k += 0x9E3779B97F4A7C15ULL;
+    k = (k ^ (k >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    k = (k ^ (k >> 27)) * 0x94D049BB133111EBULL;
+    return k ^ (k >> 31);
+}
+
+// Compute board hash from scratch (root only; the search updates it incrementally)
 static inline uint64_t compute_hash(SolverContext* ctx) {
     uint64_t hash = 0;
-    int total = ctx->puzzle->width * ctx->puzzle->height;
-    for (int i = 0; i < total; i++) {
-        hash ^= ctx->zobrist[i][ctx->puzzle->board[i]];
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        uint64_t plane = ctx->planes[s];
+        while (plane) {
+            int idx = __builtin_ctzll(plane);
+            plane &= plane - 1;
+            hash ^= ctx->zobrist[idx][s];
+        }
     }
     return hash;
 }
 
 // Check cache for state
 static inline bool cache_check(SolverContext* ctx, uint64_t hash) {
-    CacheEntry* entry = &ctx->cache[hash & CACHE_MASK];
-    return entry->valid && entry->hash == hash;
-}
-
-// Add state to cache
-static inline void cache_add(SolverContext* ctx, uint64_t hash) {
-    CacheEntry* entry = &ctx->cache[hash & CACHE_MASK];
-    entry->hash = hash;
-    entry->valid = true;
+    const TTBucket* bucket = &ctx->tt[hash & ctx->tt_bucket_mask];
+    uint64_t tag = hash >> TT_TAG_SHIFT;
+    
+    for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        uint64_t e = bucket->entries[i];
+        if ((e >> TT_TAG_SHIFT) == tag && (e & TT_GEN_MASK) == ctx->tt_generation &&
+            (e & TT_FLAG_NO_SOLUTION)) {
+            ctx->tt_hits++;
+            return true;
+        }
+    }
+    ctx->tt_misses++;
+    return false;
 }
 
 /**
- * Count shapes matching target in cells specified by mask
- * For final solution checking: Cat counts as matching any non-cat shape
+ * Add state to cache
+ * Replacement: reuse a slot from an older generation if there is one,
+ * otherwise evict the entry summarising the smallest subtree.
  */
-static inline int count_shapes(const Puzzle* p, uint64_t mask, uint8_t target_shape) {
-    int count = 0;
-    bool is_cat_target = (target_shape == SHAPE_CAT);
+static inline void cache_add(SolverContext* ctx, uint64_t hash, uint64_t subtree_states) {
+    TTBucket* bucket = &ctx->tt[hash & ctx->tt_bucket_mask];
+    uint64_t weight = 64 - __builtin_clzll(subtree_states | 1);
     
-    while (mask) {
-        int idx = __builtin_ctzll(mask);  // Count trailing zeros = lowest set bit
-        mask &= mask - 1;  // Clear lowest set bit
-        
-        uint8_t cell_shape = p->board[idx];
-        if (cell_shape == target_shape || 
-            (!is_cat_target && cell_shape == SHAPE_CAT)) {
-            count++;
+    int victim = 0;
+    uint64_t victim_weight = UINT64_MAX;
+    for (int i = 0; i < TT_BUCKET_ENTRIES; i++) {
+        uint64_t e = bucket->entries[i];
+        if ((e & TT_GEN_MASK) != ctx->tt_generation) {
+            victim = i;
+            break;
+        }
+        uint64_t w = (e >> TT_WEIGHT_SHIFT) & TT_WEIGHT_MASK;
+        if (w < victim_weight) {
+            victim = i;
+            victim_weight = w;
         }
     }
-    return count;
+    
+    bucket->entries[victim] = (hash >> TT_TAG_SHIFT) << TT_TAG_SHIFT |
+                              (weight & TT_WEIGHT_MASK) << TT_WEIGHT_SHIFT |
+                              TT_FLAG_NO_SOLUTION |
+                              ctx->tt_generation;
 }
 
-/**
- * Count only committed (non-cat) shapes for early pruning
- */
-static inline int count_committed_shapes(const Puzzle* p, uint64_t mask, uint8_t target_shape) {
-    int count = 0;
+// Look up the completion count of a residual subproblem
+static inline bool memo_lookup(SolverContext* ctx, uint64_t key, uint64_t* count) {
+    const MemoBucket* bucket = &ctx->memo[key & ctx->tt_bucket_mask];
     
-    while (mask) {
-        int idx = __builtin_ctzll(mask);
-        mask &= mask - 1;
-        
-        if (p->board[idx] == target_shape) {
-            count++;
+    for (int i = 0; i < MEMO_BUCKET_ENTRIES; i++) {
+        const MemoEntry* e = &bucket->entries[i];
+        if (e->key == key && (e->value & TT_GEN_MASK) == ctx->tt_generation) {
+            *count = e->value >> TT_GEN_BITS;
+            ctx->tt_hits++;
+            return true;
         }
     }
-    return count;
+    ctx->tt_misses++;
+    return false;
 }
 
 /**
- * Count cats in a region
+ * Record the completion count of a residual subproblem
+ * Replacement: reuse a slot from an older generation if there is one,
+ * otherwise pick a slot from the key's top bits.
  */
-static inline int count_cats(const Puzzle* p, uint64_t mask) {
-    int count = 0;
+static inline void memo_store(SolverContext* ctx, uint64_t key, uint64_t count) {
+    if (count > MEMO_MAX_COUNT) return;
     
-    while (mask) {
-        int idx = __builtin_ctzll(mask);
-        mask &= mask - 1;
-        
-        if (p->board[idx] == SHAPE_CAT) {
-            count++;
+    MemoBucket* bucket = &ctx->memo[key & ctx->tt_bucket_mask];
+    int victim = (int)(key >> 62);
+    for (int i = 0; i < MEMO_BUCKET_ENTRIES; i++) {
+        if ((bucket->entries[i].value & TT_GEN_MASK) != ctx->tt_generation) {
+            victim = i;
+            break;
         }
     }
-    return count;
+    
+    bucket->entries[victim].key = key;
+    bucket->entries[victim].value = count << TT_GEN_BITS | ctx->tt_generation;
+}
+
+/**
+ * Count shapes matching target in cells specified by mask
+ * For final solution checking: Cat counts as matching any non-cat shape
+ */
+static inline int count_shapes(const uint64_t* planes, uint64_t mask, uint8_t target_shape) {
+    uint64_t matching = planes[target_shape];
+    if (target_shape != SHAPE_CAT) {
+        matching |= planes[SHAPE_CAT];
+    }
+    return __builtin_popcountll(mask & matching);
+}
+
+/**
+ * Check a final count against a constraint's operator
+ * Cell constraints are counts over a single-cell region:
+ * "is X" needs the cell to match X, "is not X" needs it not to.
+ */
+static inline bool count_satisfies(const Constraint* c, int count) {
+    switch (c->op) {
+        case OP_EXACTLY:  return count == c->count;
+        case OP_AT_LEAST: return count >= c->count;
+        case OP_AT_MOST:  return count <= c->count;
+        case OP_NONE:     return count == 0;
+        case OP_IS:       return count == 1;
+        case OP_IS_NOT:   return count == 0;
+        default:          return false;
+    }
 }
 
 /**
  * Check if a single constraint is satisfied (for final solution check)
  */
-static bool check_constraint(const Puzzle* p, const Constraint* c) {
+static bool check_constraint(const Puzzle* p, const uint64_t* planes, const Constraint* c) {
+    uint64_t mask = c->cell_mask;
     if (c->type == CONSTRAINT_CELL) {
-        int idx = cell_index(c->cell_x, c->cell_y, p->width);
-        uint8_t cell_shape = p->board[idx];
-        
-        if (c->op == OP_IS) {
-            if (c->shape == SHAPE_CAT) {
-                return cell_shape == SHAPE_CAT;
-            }
-            // Cat satisfies any "is X" constraint for non-cat X
-            return cell_shape == c->shape || cell_shape == SHAPE_CAT;
-        } else { // OP_IS_NOT
-            if (c->shape == SHAPE_CAT) {
-                return cell_shape != SHAPE_CAT;
-            }
-            // Cell must not be X, and must not be Cat (Cat could become X)
-            return cell_shape != c->shape && cell_shape != SHAPE_CAT;
-        }
-    } else {
-        // Count constraint
-        int count = count_shapes(p, c->cell_mask, c->shape);
-        
-        switch (c->op) {
-            case OP_EXACTLY:  return count == c->count;
-            case OP_AT_LEAST: return count >= c->count;
-            case OP_AT_MOST:  return count <= c->count;
-            case OP_NONE:     return count == 0;
-            default:          return false;
-        }
+        mask = 1ULL << cell_index(c->cell_x, c->cell_y, p->width);
     }
+    return count_satisfies(c, count_shapes(planes, mask, c->shape));
 }
 
 /**
  * Check if all constraints are satisfied (complete solution check)
  */
-static bool all_constraints_satisfied(const Puzzle* p) {
+static bool all_constraints_satisfied(const Puzzle* p, const uint64_t* planes) {
     for (int i = 0; i < p->num_constraints; i++) {
-        if (!check_constraint(p, &p->constraints[i])) {
+        if (!check_constraint(p, planes, &p->constraints[i])) {
             return false;
         }
     }
@@ -222,278 +560,1043 @@ static bool all_constraints_satisfied(const Puzzle* p) {
 }
 
 /**
- * Check if any constraint is definitely violated (early pruning)
- * Enhanced with tighter bounds checking for count constraints
- * 
- * Note: Cat count constraints are handled specially because SHAPE_CAT serves
- * as both "superposition" (unresolved) and "actual cat" in solutions. We can't
- * easily distinguish them during solving, so we skip tight bounds pruning for cats.
+ * Check if all constraints are satisfied using the running counters
+ * Only valid once every cell has been assigned
  */
-static bool has_violated_constraint(const Puzzle* p) {
-    for (int i = 0; i < p->num_constraints; i++) {
-        const Constraint* c = &p->constraints[i];
-        
-        if (c->type == CONSTRAINT_CELL) {
-            int idx = cell_index(c->cell_x, c->cell_y, p->width);
-            uint8_t cell_shape = p->board[idx];
-            
-            if (c->op == OP_IS_NOT) {
-                // Violated if cell IS the forbidden shape (and not Cat)
-                if (cell_shape == c->shape && cell_shape != SHAPE_CAT) {
-                    return true;
-                }
-            } else if (c->op == OP_IS) {
-                // If cell is committed to a different concrete shape, violated
-                if (cell_shape != SHAPE_CAT && cell_shape != c->shape && c->shape != SHAPE_CAT) {
-                    return true;
-                }
-            }
-        } else {
-            // Count constraint - enhanced bounds checking
-            // Skip tight bounds checking for cat constraints (SHAPE_CAT is ambiguous)
-            if (c->shape == SHAPE_CAT) {
-                continue;  // Cat count validated at end, not during pruning
-            }
-            
-            int committed_count = count_committed_shapes(p, c->cell_mask, c->shape);
-            int cat_count = count_cats(p, c->cell_mask);
-            int max_possible = committed_count + cat_count;
-            
-            switch (c->op) {
-                case OP_EXACTLY:
-                    if (committed_count > c->count || max_possible < c->count) {
-                        return true;
-                    }
-                    break;
-                    
-                case OP_AT_LEAST:
-                    if (max_possible < c->count) {
-                        return true;
-                    }
-                    break;
-                    
-                case OP_AT_MOST:
-                    if (committed_count > c->count) {
-                        return true;
-                    }
-                    break;
-                    
-                case OP_NONE:
-                    if (committed_count > 0) {
-                        return true;
-                    }
-                    break;
-                    
-                default:
-                    break;
-            }
-        }
+static bool all_counters_satisfied(const SolverContext* ctx) {
+#ifdef __AVX2__
+    // No cell is open any more, so committed is every lane's final count
+    __m256i count = _mm256_load_si256((const __m256i*)ctx->counters.committed);
+    __m256i lo = _mm256_load_si256((const __m256i*)ctx->count_lo);
+    __m256i hi = _mm256_load_si256((const __m256i*)ctx->count_hi);
+    
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(count, lo), count),
+                                  _mm256_cmpeq_epi8(_mm256_max_epu8(count, hi), hi));
+    return _mm256_movemask_epi8(ok) == -1;
+#else
+    bool ok = true;
+    for (int i = 0; i < MAX_CONSTRAINTS; i++) {
+        int count = ctx->counters.committed[i];
+        ok &= (count >= ctx->count_lo[i]) & (count <= ctx->count_hi[i]);
     }
-    return false;
+    return ok;
+#endif
 }
 
 /**
- * Initialize domains for all cells based on constraints
- * This is done once at the start of solving
+ * Key a node by its residual subproblem, for the count memo
+ * 
+ * The number of completions below a node depends only on which cells are
+ * still open and, for each constraint whose region still has open cells,
+ * how much the decided cells already contribute to its final count.
+ * Different prefixes that agree on those share a key, which is what lets
+ * counting reuse whole subtrees. Constraints with no open cells left are
+ * final: returns false if one of them is unsatisfied (no completions).
  */
-static void init_domains(SolverContext* ctx) {
-    Puzzle* p = ctx->puzzle;
-    int total = p->width * p->height;
-    
-    // Start with all shapes possible
-    for (int i = 0; i < total; i++) {
-        if (is_locked(p, i)) {
-            ctx->domains[i] = (1 << p->board[i]);
-        } else {
-            ctx->domains[i] = DOMAIN_ALL;
-        }
-    }
+static bool residual_key(const SolverContext* ctx, uint64_t open, uint64_t* key) {
+    uint64_t k = mix64(open);
     
-    // Apply cell constraints to reduce domains
-    for (int i = 0; i < p->num_constraints; i++) {
-        const Constraint* c = &p->constraints[i];
+    for (int i = 0; i < ctx->num_lanes; i++) {
+        int decided = count_shapes(ctx->planes, ctx->masks[i] & ~open, ctx->shapes[i]);
         
-        if (c->type == CONSTRAINT_CELL) {
-            int idx = cell_index(c->cell_x, c->cell_y, p->width);
-            
-            if (c->op == OP_IS) {
-                if (c->shape == SHAPE_CAT) {
-                    ctx->domains[idx] &= DOMAIN_CAT;
-                } else {
-                    // Can be the shape or Cat
-                    ctx->domains[idx] &= ((1 << c->shape) | DOMAIN_CAT);
-                }
-            } else if (c->op == OP_IS_NOT) {
-                if (c->shape == SHAPE_CAT) {
-                    ctx->domains[idx] &= DOMAIN_CONCRETE;
-                } else {
-                    ctx->domains[idx] &= ~((1 << c->shape) | DOMAIN_CAT);
-                }
-            }
+        if (ctx->masks[i] & open) {
+            k ^= ctx->residual_keys[i][decided];
+        } else if (decided < ctx->count_lo[i] || decided > ctx->count_hi[i]) {
+            return false;
         }
     }
+    
+    *key = k;
+    return true;
 }
 
 /**
- * Recursive backtracking solver
+ * Normalize a constraint to the interval [lo, hi] its final count must
+ * fall in (cell constraints are counts over a single-cell region)
  */
-static void solve_recursive(SolverContext* ctx, int cell_index_start) {
-    // Early exit if we've found enough solutions
-    if (ctx->max_solutions > 0 && ctx->solution_count >= ctx->max_solutions) {
-        return;
-    }
-    
-    ctx->states_explored++;
-    
-    Puzzle* p = ctx->puzzle;
-    int total_cells = p->width * p->height;
+void solver_constraint_bounds(const Constraint* c, uint8_t* lo, uint8_t* hi) {
+    *lo = 0;
+    *hi = UINT8_MAX;
     
-    // Find next unfilled cell (Cat cell that isn't locked)
-    int cell_idx = cell_index_start;
-    while (cell_idx < total_cells && 
-           (is_locked(p, cell_idx) || p->board[cell_idx] != SHAPE_CAT)) {
-        cell_idx++;
+    switch (c->op) {
+        case OP_EXACTLY:  *lo = c->count; *hi = c->count; break;
+        case OP_AT_LEAST: *lo = c->count; break;
+        case OP_AT_MOST:  *hi = c->count; break;
+        case OP_NONE:
+        case OP_IS_NOT:   *hi = 0; break;
+        case OP_IS:       *lo = 1; *hi = 1; break;
+        default:          *lo = 1; *hi = 0; break;  // Unknown op: never satisfied
     }
+}
+
+/**
+ * Check if a constraint is definitely violated given its running counts
+ */
+static inline bool constraint_violated(const SolverContext* ctx, int i) {
+    return (ctx->counters.committed[i] > ctx->count_hi[i]) |
+           (ctx->counters.committed[i] + ctx->counters.open[i] < ctx->count_lo[i]);
+}
+
+/**
+ * Bit i set for every constraint that is definitely violated (full scan)
+ */
+static uint32_t violated_constraints(const SolverContext* ctx) {
+#ifdef __AVX2__
+    __m256i committed = _mm256_load_si256((const __m256i*)ctx->counters.committed);
+    __m256i open = _mm256_load_si256((const __m256i*)ctx->counters.open);
+    __m256i lo = _mm256_load_si256((const __m256i*)ctx->count_lo);
+    __m256i hi = _mm256_load_si256((const __m256i*)ctx->count_hi);
+    __m256i reach = _mm256_adds_epu8(committed, open);
     
-    // Base case: all cells filled
-    if (cell_idx >= total_cells) {
-        if (all_constraints_satisfied(p)) {
-            ctx->solution_count++;
-            ctx->found_solution = true;
-        }
-        return;
+    // Unsigned a <= b  <=>  max(a, b) == b
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(committed, hi), hi),
+                                  _mm256_cmpeq_epi8(_mm256_max_epu8(reach, lo), reach));
+    return ~(uint32_t)_mm256_movemask_epi8(ok);
+#else
+    uint32_t violated = 0;
+    for (int i = 0; i < MAX_CONSTRAINTS; i++) {
+        violated |= (uint32_t)constraint_violated(ctx, i) << i;
     }
-    
-    // Early pruning
-    if (has_violated_constraint(p)) {
-        return;
+    return violated;
+#endif
+}
+
+static inline bool has_violated_constraint(const SolverContext* ctx) {
+    return violated_constraints(ctx) != 0;
+}
+
+/**
+ * Decision levels behind the current domains of the cells in region
+ */
+static uint64_t region_reason(const SolverContext* ctx, uint64_t region) {
+    uint64_t reason = 0;
+    while (region) {
+        reason |= ctx->reasons[__builtin_ctzll(region)];
+        region &= region - 1;
     }
-    
-    // State caching
-    uint64_t hash = compute_hash(ctx);
-    if (cache_check(ctx, hash)) {
-        return;
+    return reason;
+}
+
+/**
+ * Decision levels behind every violated constraint in the mask: the
+ * decided cells that count toward it when over the bound, the decided
+ * cells that do not when under it
+ */
+static uint64_t violation_reason(const SolverContext* ctx, uint32_t violated) {
+    uint64_t reason = 0;
+    while (violated) {
+        int i = __builtin_ctz(violated);
+        violated &= violated - 1;
+        
+        uint64_t decided = ctx->masks[i] & ~ctx->open;
+        uint64_t counted = ctx->planes[ctx->shapes[i]] | ctx->planes[SHAPE_CAT];
+        uint64_t cause = (ctx->counters.committed[i] > ctx->count_hi[i]) ?
+                         decided & counted : decided & ~counted;
+        reason |= region_reason(ctx, cause);
     }
+    return reason;
+}
+
+/**
+ * Presolve: compile the puzzle's constraints into lanes, one per distinct
+ * (region, shape) pair. Constraints on the same pair intersect into one
+ * [lo, hi] interval ("at least 1 Circle" and "exactly 2 Circles" in the
+ * same row become [2, 2]), hi is clamped to the region size, and lanes
+ * that every count satisfies are dropped. Returns false if some interval
+ * is empty, i.e. the puzzle has no solution.
+ */
+static bool compile_lanes(SolverContext* ctx) {
+    const Puzzle* p = ctx->puzzle;
+    bool feasible = true;
     
-    uint8_t original_shape = p->board[cell_idx];
-    uint8_t domain = ctx->domains[cell_idx];
-    bool found_any = false;
+    // Neutral lanes for unused constraint slots
+    memset(ctx->masks, 0, sizeof(ctx->masks));
+    memset(ctx->shapes, SHAPE_CAT, sizeof(ctx->shapes));
+    memset(ctx->count_lo, 0, sizeof(ctx->count_lo));
+    memset(ctx->count_hi, UINT8_MAX, sizeof(ctx->count_hi));
     
-    // Try shapes in domain, concrete shapes first (better for pruning)
-    // Order: Square, Circle, Triangle, then Cat
-    for (uint8_t s = SHAPE_SQUARE; s <= SHAPE_TRIANGLE; s++) {
-        if (ctx->max_solutions > 0 && ctx->solution_count >= ctx->max_solutions) {
-            break;
-        }
+    int n = 0;
+    for (int c = 0; c < p->num_constraints; c++) {
+        const Constraint* con = &p->constraints[c];
+        uint8_t lo, hi;
+        solver_constraint_bounds(con, &lo, &hi);
         
-        if (domain & (1 << s)) {
-            p->board[cell_idx] = s;
-            solve_recursive(ctx, cell_idx + 1);
-            if (ctx->solution_count > 0) found_any = true;
+        int i = 0;
+        while (i < n && (ctx->masks[i] != con->cell_mask || ctx->shapes[i] != con->shape)) {
+            i++;
+        }
+        if (i == n) {
+            n++;
+            ctx->masks[i] = con->cell_mask;
+            ctx->shapes[i] = con->shape;
+            ctx->count_hi[i] = __builtin_popcountll(con->cell_mask);
         }
+        if (lo > ctx->count_lo[i]) ctx->count_lo[i] = lo;
+        if (hi < ctx->count_hi[i]) ctx->count_hi[i] = hi;
     }
     
-    // Try Cat last (superposition is harder to prune)
-    if (domain & DOMAIN_CAT) {
-        if (!(ctx->max_solutions > 0 && ctx->solution_count >= ctx->max_solutions)) {
-            p->board[cell_idx] = SHAPE_CAT;
-            solve_recursive(ctx, cell_idx + 1);
-            if (ctx->solution_count > 0) found_any = true;
+    // Drop vacuous lanes, keeping the rest in first-seen order
+    ctx->num_lanes = 0;
+    for (int i = 0; i < n; i++) {
+        feasible &= ctx->count_lo[i] <= ctx->count_hi[i];
+        if (ctx->count_lo[i] == 0 && ctx->count_hi[i] == __builtin_popcountll(ctx->masks[i])) {
+            continue;
         }
+        
+        int k = ctx->num_lanes++;
+        ctx->masks[k] = ctx->masks[i];
+        ctx->shapes[k] = ctx->shapes[i];
+        ctx->count_lo[k] = ctx->count_lo[i];
+        ctx->count_hi[k] = ctx->count_hi[i];
     }
-    
-    // Restore original shape
-    p->board[cell_idx] = original_shape;
-    
-    // Cache negative results
-    if (!found_any && ctx->solution_count == 0) {
-        cache_add(ctx, hash);
+    for (int k = ctx->num_lanes; k < n; k++) {
+        ctx->masks[k] = 0;
+        ctx->shapes[k] = SHAPE_CAT;
+        ctx->count_lo[k] = 0;
+        ctx->count_hi[k] = UINT8_MAX;
     }
+    return feasible;
 }
 
 /**
- * Pre-compute cell masks for each constraint
+ * Build the cell-to-lane adjacency index and initialize the running
+ * counters from the current planes and open mask
  */
-void solver_precompute_masks(Puzzle* puzzle) {
-    for (int i = 0; i < puzzle->num_constraints; i++) {
-        Constraint* c = &puzzle->constraints[i];
-        c->cell_mask = 0;
+static void init_counters(SolverContext* ctx) {
+    memset(ctx->cell_constraints, 0, sizeof(ctx->cell_constraints));
+    memset(ctx->cell_lanes, 0, sizeof(ctx->cell_lanes));
+    memset(ctx->shape_lanes, 0, sizeof(ctx->shape_lanes));
+    memset(&ctx->counters, 0, sizeof(ctx->counters));
+    
+    for (int i = 0; i < ctx->num_lanes; i++) {
+        uint64_t mask = ctx->masks[i];
+        while (mask) {
+            int idx = __builtin_ctzll(mask);
+            mask &= mask - 1;
+            ctx->cell_constraints[idx] |= (1U << i);
+            ctx->cell_lanes[idx][i] = 1;
+        }
         
-        switch (c->type) {
-            case CONSTRAINT_GLOBAL:
-                for (int idx = 0; idx < puzzle->width * puzzle->height; idx++) {
-                    c->cell_mask |= (1ULL << idx);
-                }
-                break;
-                
-            case CONSTRAINT_ROW:
-                for (int x = 0; x < puzzle->width; x++) {
-                    int idx = cell_index(x, c->index, puzzle->width);
-                    c->cell_mask |= (1ULL << idx);
-                }
-                break;
-                
-            case CONSTRAINT_COLUMN:
-                for (int y = 0; y < puzzle->height; y++) {
-                    int idx = cell_index(c->index, y, puzzle->width);
-                    c->cell_mask |= (1ULL << idx);
-                }
-                break;
-                
-            case CONSTRAINT_CELL:
-                c->cell_mask = 1ULL << cell_index(c->cell_x, c->cell_y, puzzle->width);
-                break;
+        ctx->shape_lanes[SHAPE_CAT][i] = 1;
+        ctx->shape_lanes[ctx->shapes[i]][i] = 1;
+        
+        uint64_t counted = ctx->planes[ctx->shapes[i]] | ctx->planes[SHAPE_CAT];
+        ctx->counters.committed[i] = __builtin_popcountll(ctx->masks[i] & ~ctx->open & counted);
+        ctx->counters.open[i] = __builtin_popcountll(ctx->masks[i] & ctx->open);
+    }
+}
+
+// Domain of a single cell as a 4-bit shape mask
+static inline uint8_t cell_domain(const SolverContext* ctx, int idx) {
+    uint8_t domain = 0;
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        domain |= ((ctx->domains[s] >> idx) & 1) << s;
+    }
+    return domain;
+}
+
+static inline void set_cell_domain(SolverContext* ctx, int idx, uint8_t domain) {
+    uint64_t bit = 1ULL << idx;
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        if (domain & (1 << s)) {
+            ctx->domains[s] |= bit;
+        } else {
+            ctx->domains[s] &= ~bit;
         }
     }
 }
 
 /**
- * Extended solve function with reusable context and max solutions
+ * Decide an open cell as shape s (by branching or by propagation), for
+ * the given reason. Updates only the constraints that cover the cell and
+ * returns false (with ctx->conflict set) if any of them is now violated.
+ * Everything is trailed either way; undo with restore_checkpoint().
  */
-SolverResult solver_solve_ex(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions) {
-    SolverResult result = {0};
-    bool own_context = (ctx == NULL);
+static bool assign_cell(SolverContext* ctx, int idx, uint8_t s, uint64_t reason) {
+    uint64_t bit = 1ULL << idx;
     
-    // Ensure masks are computed
-    solver_precompute_masks(puzzle);
+    TrailEntry* t = &ctx->trail[ctx->trail_len++];
+    t->cell = idx;
+    t->old_domain = cell_domain(ctx, idx);
+    t->shape = s;
+    t->old_reason = ctx->reasons[idx];
     
-    // Create or reuse context
-    if (own_context) {
-        ctx = solver_context_create();
-        if (!ctx) return result;
-    } else {
-        solver_context_reset(ctx);
-    }
+    set_cell_domain(ctx, idx, 1 << s);
+    ctx->reasons[idx] = reason;
+    ctx->open &= ~bit;
     
-    ctx->puzzle = puzzle;
-    ctx->max_solutions = max_solutions;
+    // A cell decided as Cat stays in the Cat plane; only the counters
+    // see the difference between it and an open cell
+    if (s != SHAPE_CAT) {
+        ctx->planes[SHAPE_CAT] &= ~bit;
+        ctx->planes[s] |= bit;
+        ctx->hash ^= ctx->zobrist[idx][SHAPE_CAT] ^ ctx->zobrist[idx][s];
+    }
     
-    // Initialize domains based on constraints
-    init_domains(ctx);
+#ifdef __AVX2__
+    // Every lane at once: the cell leaves the open count of the constraints
+    // covering it and joins the committed count of those counting s.
+    // Untouched lanes were already consistent, so checking all is exact.
+    __m256i touched = _mm256_load_si256((const __m256i*)ctx->cell_lanes[idx]);
+    __m256i counts_s = _mm256_load_si256((const __m256i*)ctx->shape_lanes[s]);
+    __m256i* open = (__m256i*)ctx->counters.open;
+    __m256i* committed = (__m256i*)ctx->counters.committed;
     
-    // Check for empty domains (immediate contradiction)
-    int total = puzzle->width * puzzle->height;
-    for (int i = 0; i < total; i++) {
-        if (ctx->domains[i] == 0) {
-            result.solution_count = 0;
-            result.is_solvable = false;
-            if (own_context) solver_context_destroy(ctx);
-            return result;
-        }
+    _mm256_store_si256(open, _mm256_sub_epi8(_mm256_load_si256(open), touched));
+    _mm256_store_si256(committed, _mm256_add_epi8(_mm256_load_si256(committed),
+                                                  _mm256_and_si256(touched, counts_s)));
+    uint32_t violated = violated_constraints(ctx);
+#else
+    uint32_t violated = 0;
+    uint32_t touched = ctx->cell_constraints[idx];
+    while (touched) {
+        int i = __builtin_ctz(touched);
+        touched &= touched - 1;
+        
+        ctx->counters.open[i]--;
+        ctx->counters.committed[i] += (s == SHAPE_CAT) | (ctx->shapes[i] == s);
+        violated |= (uint32_t)constraint_violated(ctx, i) << i;
     }
+#endif
+    if (violated) {
+        ctx->conflict = violation_reason(ctx, violated);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Narrow an open cell's domain to domain & allowed, which follows from the
+ * decision levels in reason. A singleton result is assigned straight away.
+ * Constraints covering the cell are added to *pending for re-propagation.
+ * Returns false (with ctx->conflict set) on a wipe-out or violation.
+ */
+static bool restrict_domain(SolverContext* ctx, int idx, uint8_t allowed, uint64_t reason,
+                            uint32_t* pending) {
+    uint8_t old_domain = cell_domain(ctx, idx);
+    uint8_t domain = old_domain & allowed;
     
-    // Time the solve
-    clock_t start = clock();
+    if (domain == old_domain) return true;
     
-    solve_recursive(ctx, 0);
+    reason |= ctx->reasons[idx];
+    if (domain == 0) {
+        ctx->conflict = reason;
+        return false;
+    }
     
+    *pending |= ctx->cell_constraints[idx];
+    
+    if ((domain & (domain - 1)) == 0) {
+        return assign_cell(ctx, idx, __builtin_ctz(domain), reason);
+    }
+    
+    TrailEntry* t = &ctx->trail[ctx->trail_len++];
+    t->cell = idx;
+    t->old_domain = old_domain;
+    t->shape = TRAIL_DOMAIN_ONLY;
+    t->old_reason = ctx->reasons[idx];
+    set_cell_domain(ctx, idx, domain);
+    ctx->reasons[idx] = reason;
+    return true;
+}
+
+/**
+ * Constraint propagation to a fixpoint over the pending constraints.
+ * 
+ * For a constraint on shape X, the cells that count towards its final
+ * count are X and Cat (just Cat when X is Cat). Let fixed be the decided
+ * cells that count and max the fixed cells plus the open cells that could
+ * still count. Then:
+ * - fixed > hi or max < lo:  contradiction
+ * - max == lo:  every candidate open cell must count (domain &= {X, Cat})
+ * - fixed == hi: no open cell may count (domain &= ~{X, Cat})
+ * Every forced change is trailed and re-queues the constraints it touches.
+ * Reasons: anything that follows from fixed depends only on the decided
+ * counting cells, anything that follows from max only on the cells that
+ * can no longer count.
+ */
+static bool propagate(SolverContext* ctx, uint32_t pending) {
+    while (pending) {
+        int i = __builtin_ctz(pending);
+        pending &= pending - 1;
+        
+        uint8_t shape = ctx->shapes[i];
+        uint8_t counting = DOMAIN_CAT | (1 << shape);
+        uint64_t region = ctx->masks[i];
+        uint64_t counted = ctx->planes[SHAPE_CAT] | ctx->planes[shape];
+        uint64_t candidates = region & ctx->open &
+                              (ctx->domains[SHAPE_CAT] | ctx->domains[shape]);
+        
+        uint64_t fixed_cells = region & ~ctx->open & counted;
+        uint64_t blocked_cells = region & ~fixed_cells & ~candidates;
+        int fixed = __builtin_popcountll(fixed_cells);
+        int max_possible = fixed + __builtin_popcountll(candidates);
+        
+        if (fixed > ctx->count_hi[i]) {
+            ctx->conflict = region_reason(ctx, fixed_cells);
+            return false;
+        }
+        if (max_possible < ctx->count_lo[i]) {
+            ctx->conflict = region_reason(ctx, blocked_cells);
+            return false;
+        }
+        
+        uint8_t allowed;
+        uint64_t reason;
+        if (max_possible == ctx->count_lo[i]) {
+            allowed = counting;
+            reason = region_reason(ctx, blocked_cells);
+        } else if (fixed == ctx->count_hi[i]) {
+            allowed = DOMAIN_ALL & ~counting;
+            reason = region_reason(ctx, fixed_cells);
+        } else {
+            continue;
+        }
+        
+        while (candidates) {
+            int idx = __builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            
+            if (!restrict_domain(ctx, idx, allowed, reason, &pending)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static inline void save_checkpoint(const SolverContext* ctx, Checkpoint* cp) {
+    cp->trail_len = ctx->trail_len;
+    cp->hash = ctx->hash;
+    cp->counters = ctx->counters;
+}
+
+/**
+ * Undo every trailed change made since the checkpoint was saved
+ */
+static void restore_checkpoint(SolverContext* ctx, const Checkpoint* cp) {
+    while (ctx->trail_len > cp->trail_len) {
+        const TrailEntry* t = &ctx->trail[--ctx->trail_len];
+        uint64_t bit = 1ULL << t->cell;
+        
+        set_cell_domain(ctx, t->cell, t->old_domain);
+        ctx->reasons[t->cell] = t->old_reason;
+        if (t->shape != TRAIL_DOMAIN_ONLY) {
+            ctx->open |= bit;
+            ctx->planes[t->shape] &= ~bit;
+            ctx->planes[SHAPE_CAT] |= bit;
+        }
+    }
+    ctx->hash = cp->hash;
+    ctx->counters = cp->counters;
+}
+
+/**
+ * Failed-literal probing at the root: assign each live (cell, shape) in
+ * turn, propagate, and remove the values that fail straight away. Each
+ * removal can make other values fail, so passes repeat until one removes
+ * nothing or the deadline passes. Removals hold unconditionally (reason
+ * 0), exactly like root propagation. Returns false if the root is refuted.
+ */
+static bool probe_root(SolverContext* ctx, double deadline_ms) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        
+        uint64_t cells = ctx->open;
+        while (cells) {
+            int idx = __builtin_ctzll(cells);
+            cells &= cells - 1;
+            
+            for (int s = 0; s < SHAPE_COUNT && (ctx->open >> idx) & 1; s++) {
+                if (!((ctx->domains[s] >> idx) & 1)) continue;
+                if (solver_now_ms() >= deadline_ms) return true;
+                
+                Checkpoint cp;
+                save_checkpoint(ctx, &cp);
+                bool consistent = assign_cell(ctx, idx, s, 0) &&
+                                  propagate(ctx, ctx->cell_constraints[idx]);
+                restore_checkpoint(ctx, &cp);
+                if (consistent) continue;
+                
+                uint32_t pending = 0;
+                changed = true;
+                if (!restrict_domain(ctx, idx, (uint8_t)~(1 << s), 0, &pending) ||
+                    !propagate(ctx, pending)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Initialize domains for all cells based on constraints
+ * This is done once at the start of solving; decided cells get a
+ * singleton domain and cell constraints are applied by the first
+ * propagation pass.
+ */
+static void init_domains(SolverContext* ctx) {
+    Puzzle* p = ctx->puzzle;
+    uint64_t board_mask = (p->width * p->height == 64) ? ~0ULL :
+                          (1ULL << (p->width * p->height)) - 1;
+    
+    ctx->open = ctx->planes[SHAPE_CAT] & ~p->locked_mask & board_mask;
+    ctx->trail_len = 0;
+    memset(ctx->reasons, 0, sizeof(ctx->reasons));
+    ctx->num_nogoods = 0;
+    ctx->next_nogood = 0;
+    
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        ctx->domains[s] = ctx->open | (ctx->planes[s] & ~ctx->open);
+    }
+}
+
+/**
+ * Most-constrained-cell selection: the open cell with the fewest live
+ * shapes, ties broken by how many of its constraints are within one
+ * cell of a bound (those are the next to force), then by index.
+ */
+static int select_cell(const SolverContext* ctx) {
+    uint64_t open = ctx->open;
+    uint64_t d0 = ctx->domains[0] & open, d1 = ctx->domains[1] & open;
+    uint64_t d2 = ctx->domains[2] & open, d3 = ctx->domains[3] & open;
+    
+    // Bit-sliced popcount of each cell's domain (open cells have 2..4)
+    uint64_t lo_sum = d0 ^ d1, lo_carry = d0 & d1;
+    uint64_t hi_sum = d2 ^ d3, hi_carry = d2 & d3;
+    uint64_t bit0 = lo_sum ^ hi_sum;
+    uint64_t mid_carry = lo_sum & hi_sum;
+    uint64_t bit1 = lo_carry ^ hi_carry ^ mid_carry;
+    uint64_t size4 = d0 & d1 & d2 & d3;
+    
+    uint64_t best = open & ~bit0 & bit1 & ~size4;  // Domain size 2
+    if (!best) best = open & bit0 & bit1;           // Domain size 3
+    if (!best) best = open;
+    
+    if ((best & (best - 1)) == 0) {
+        return __builtin_ctzll(best);
+    }
+    
+    // Constraints with open cells that are one step from a bound
+    uint32_t tight = 0;
+    for (int i = 0; i < ctx->num_lanes; i++) {
+        uint64_t region = ctx->masks[i];
+        uint8_t shape = ctx->shapes[i];
+        uint64_t candidates = region & open &
+                              (ctx->domains[SHAPE_CAT] | ctx->domains[shape]);
+        if (!candidates) continue;
+        
+        int fixed = __builtin_popcountll(region & ~open &
+                                         (ctx->planes[SHAPE_CAT] | ctx->planes[shape]));
+        int max_possible = fixed + __builtin_popcountll(candidates);
+        if (fixed + 1 >= ctx->count_hi[i] || max_possible - 1 <= ctx->count_lo[i]) {
+            tight |= 1U << i;
+        }
+    }
+    
+    int best_cell = __builtin_ctzll(best);
+    int best_score = -1;
+    while (best) {
+        int idx = __builtin_ctzll(best);
+        best &= best - 1;
+        
+        int score = __builtin_popcount(ctx->cell_constraints[idx] & tight);
+        if (score > best_score) {
+            best_score = score;
+            best_cell = idx;
+        }
+    }
+    return best_cell;
+}
+
+// SOLVER_ENGINE_AUTO tries the row engine from this board size up, on a
+// budget of this many row states before falling back to cells
+#define ROW_ENGINE_MIN_CELLS    25
+#define ROW_ENGINE_TRIAL_STATES (1u << 16)
+
+// Automatic split depth aims for at least this many subproblems per thread
+#define SPLIT_TASKS_PER_THREAD 8
+
+// Parallel counting first runs a serial search of up to this many states
+#define PARALLEL_TRIAL_STATES (1u << 16)
+
+// The deadline is polled every this many states (power of 2)
+#define DEADLINE_CHECK_INTERVAL 1024
+
+double solver_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1e6;
+}
+
+// Branch order: concrete shapes first (better for pruning), then Cat
+// (superposition is harder to prune)
+static const uint8_t BRANCH_ORDER[SHAPE_COUNT] = {
+    SHAPE_SQUARE, SHAPE_CIRCLE, SHAPE_TRIANGLE, SHAPE_CAT
+};
+
+static inline bool solution_limit_reached(const SolverContext* ctx) {
+    return ctx->max_solutions > 0 && ctx->solution_count >= ctx->max_solutions;
+}
+
+/**
+ * Record a complete assignment that satisfies every constraint
+ */
+static void record_solution(SolverContext* ctx) {
+    int total = ctx->puzzle->width * ctx->puzzle->height;
+    
+    ctx->solution_count++;
+    ctx->found_solution = true;
+    
+    if (ctx->num_witnesses < SOLVER_MAX_WITNESSES) {
+        store_planes(ctx->planes, ctx->witnesses[ctx->num_witnesses++], total);
+    }
+    
+    if (ctx->callback) {
+        store_planes(ctx->planes, ctx->solution_board, total);
+        if (!ctx->callback(ctx->solution_board, ctx->callback_user)) {
+            // Stopping is just a solution limit reached right here
+            ctx->max_solutions = ctx->solution_count;
+        }
+    }
+}
+
+/**
+ * Push a frame that branches on the next cell of the current state
+ */
+static SearchFrame* push_frame(SolverContext* ctx) {
+    SearchFrame* f = &ctx->stack[ctx->depth++];
+    f->cell = (ctx->ordering == SOLVER_ORDER_MOST_CONSTRAINED) ?
+              select_cell(ctx) : __builtin_ctzll(ctx->open);
+    f->domain = cell_domain(ctx, f->cell);
+    f->next = 0;
+    f->conflicts = 0;
+    f->domain_reason = ctx->reasons[f->cell];
+    save_checkpoint(ctx, &f->cp);
+    return f;
+}
+
+/**
+ * Enter the node described by the current state.
+ * Leaves, memo hits and cache hits are resolved on the spot; otherwise a
+ * frame is pushed for its children and true is returned.
+ */
+static bool enter_node(SolverContext* ctx) {
+    if (solution_limit_reached(ctx)) {
+        return false;
+    }
+    
+    uint64_t states_before = ctx->states_explored++;
+    
+    // Base case: all cells decided
+    if (ctx->open == 0) {
+        if (all_counters_satisfied(ctx)) {
+            record_solution(ctx);
+        }
+        return false;
+    }
+    
+    // Reuse the completion count of an equivalent subproblem. A count of
+    // zero is a learned nogood and prunes in every mode. Non-zero counts
+    // are only added when counting: enumeration needs every board, and a
+    // hit is ignored while witness boards are still missing.
+    uint64_t memo_key;
+    uint64_t memo_count;
+    bool counting = (ctx->max_solutions == 0 && !ctx->callback);
+    if (!residual_key(ctx, ctx->open, &memo_key)) {
+        return false;
+    }
+    if (memo_lookup(ctx, memo_key, &memo_count) &&
+        (memo_count == 0 || (counting && ctx->num_witnesses == SOLVER_MAX_WITNESSES))) {
+        ctx->solution_count += memo_count;
+        if (memo_count > 0) ctx->found_solution = true;
+        return false;
+    }
+    
+    // State caching: a node is its board plus which cells are still open
+    assert(ctx->hash == compute_hash(ctx));  // Debug builds: catch incremental hash drift
+    uint64_t node_key = ctx->hash ^ mix64(ctx->open);
+    if (cache_check(ctx, node_key)) {
+        return false;
+    }
+    
+    SearchFrame* f = push_frame(ctx);
+    f->states_before = states_before;
+    f->count_before = ctx->solution_count;
+    f->memo_key = memo_key;
+    f->node_key = node_key;
+    return true;
+}
+
+/**
+ * Check the decided cells against the learned nogoods.
+ * Returns false (with ctx->conflict set) if one of them applies.
+ */
+static bool check_nogoods(SolverContext* ctx) {
+    uint64_t decided[SHAPE_COUNT];
+    decided[SHAPE_CAT] = ctx->planes[SHAPE_CAT] & ~ctx->open;
+    for (int s = SHAPE_SQUARE; s < SHAPE_COUNT; s++) {
+        decided[s] = ctx->planes[s];
+    }
+    
+    for (int n = 0; n < ctx->num_nogoods; n++) {
+        const Nogood* ng = &ctx->nogoods[n];
+        if (ng->cells & ctx->open) continue;
+        
+        bool applies = true;
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            applies &= (ng->shapes[s] & ~decided[s]) == 0;
+        }
+        if (applies) {
+            ctx->conflict = region_reason(ctx, ng->cells);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Record the current decisions at the given levels as a nogood
+ */
+static void learn_nogood(SolverContext* ctx, uint64_t levels) {
+    Nogood* ng = &ctx->nogoods[ctx->next_nogood];
+    ctx->next_nogood = (ctx->next_nogood + 1) % NOGOOD_SLOTS;
+    if (ctx->num_nogoods < NOGOOD_SLOTS) ctx->num_nogoods++;
+    
+    memset(ng, 0, sizeof(*ng));
+    while (levels) {
+        const SearchFrame* f = &ctx->stack[__builtin_ctzll(levels)];
+        levels &= levels - 1;
+        
+        uint64_t bit = 1ULL << f->cell;
+        ng->cells |= bit;
+        ng->shapes[BRANCH_ORDER[f->next - 1]] |= bit;
+    }
+}
+
+/**
+ * Assign the frame's next viable shape and propagate.
+ * Returns true when a child node is ready to enter, false once the
+ * frame's shapes are exhausted (or enough solutions were found).
+ * The conflict levels of each failed shape are added to the frame.
+ */
+static bool next_child(SolverContext* ctx, SearchFrame* f) {
+    uint64_t level = 1ULL << (f - ctx->stack);
+    
+    while (f->next < SHAPE_COUNT && !solution_limit_reached(ctx)) {
+        uint8_t s = BRANCH_ORDER[f->next++];
+        if (!(f->domain & (1 << s))) {
+            continue;
+        }
+        
+        if (assign_cell(ctx, f->cell, s, level) &&
+            propagate(ctx, ctx->cell_constraints[f->cell]) &&
+            (ctx->num_nogoods == 0 || check_nogoods(ctx))) {
+            return true;
+        }
+        f->conflicts |= ctx->conflict;
+        restore_checkpoint(ctx, &f->cp);
+    }
+    return false;
+}
+
+/**
+ * Pop a finished frame, recording what its subtree established
+ */
+static void leave_node(SolverContext* ctx) {
+    SearchFrame* f = &ctx->stack[--ctx->depth];
+    
+    // Cache negative results: a refuted subtree stays refuted wherever the
+    // same node comes up again, including after earlier solutions
+    if (ctx->solution_count == f->count_before) {
+        cache_add(ctx, f->node_key, ctx->states_explored - f->states_before);
+    }
+    
+    // The subtree count is exact unless the solution limit cut it short
+    if (!solution_limit_reached(ctx)) {
+        memo_store(ctx, f->memo_key, ctx->solution_count - f->count_before);
+    }
+}
+
+/**
+ * Pop a frame whose shapes are exhausted.
+ * 
+ * If its subtree had no solutions, the failures below it depend only on
+ * the decision levels in its conflict set. That set is learned as a
+ * nogood when small, and every frame above the most recent level in it is
+ * popped too: their remaining shapes keep those decisions, so they would
+ * fail the same way. The set then joins the conflicts of the frame
+ * jumped to. (Failures found without analysis, such as cache hits and
+ * leaves, conservatively blame every level.)
+ */
+static void backtrack(SolverContext* ctx) {
+    SearchFrame* f = &ctx->stack[ctx->depth - 1];
+    uint64_t below = (1ULL << (ctx->depth - 1)) - 1;
+    bool refuted = ctx->solution_count == f->count_before && !solution_limit_reached(ctx);
+    uint64_t conflict = refuted ? (f->conflicts | f->domain_reason) & below : below;
+    
+    leave_node(ctx);
+    
+    if (refuted) {
+        if (conflict && __builtin_popcountll(conflict) <= NOGOOD_MAX_LITERALS) {
+            learn_nogood(ctx, conflict);
+        }
+        while (ctx->depth > 0 && !(conflict & (1ULL << (ctx->depth - 1)))) {
+            leave_node(ctx);
+        }
+    }
+    if (ctx->depth > 0) {
+        ctx->stack[ctx->depth - 1].conflicts |= conflict;
+    }
+}
+
+/**
+ * Iterative backtracking search, paused once max_nodes more states have
+ * been explored
+ * 
+ * Each branch assigns one cell and propagates; the trail restores the
+ * node afterwards. The board hash moves with the planes: committing a
+ * cell from Cat to s changes it by zobrist[cell][CAT] ^ zobrist[cell][s].
+ */
+static SolveStatus search(SolverContext* ctx, uint64_t max_nodes) {
+    uint64_t node_limit = (max_nodes > UINT64_MAX - ctx->states_explored) ?
+                          UINT64_MAX : ctx->states_explored + max_nodes;
+    
+    for (;;) {
+        if (ctx->descend) {
+            // Limits are checked between nodes, where the search can stop
+            // without leaving anything half-applied
+            if (ctx->states_explored >= ctx->limits.max_states) {
+                return SOLVE_BUDGET_EXHAUSTED;
+            }
+            if (ctx->limits.cancel &&
+                atomic_load_explicit(ctx->limits.cancel, memory_order_relaxed)) {
+                return SOLVE_CANCELLED;
+            }
+            if (ctx->limits.deadline_ms > 0 &&
+                (ctx->states_explored & (DEADLINE_CHECK_INTERVAL - 1)) == 0 &&
+                solver_now_ms() >= ctx->limits.deadline_ms) {
+                return SOLVE_BUDGET_EXHAUSTED;
+            }
+            if (ctx->states_explored >= node_limit) {
+                return SOLVE_IN_PROGRESS;
+            }
+            
+            ctx->descend = false;
+            if (enter_node(ctx)) {
+                continue;
+            }
+            if (ctx->depth == 0) {
+                return SOLVE_COMPLETE;
+            }
+            ctx->stack[ctx->depth - 1].conflicts |= (1ULL << ctx->depth) - 1;
+            restore_checkpoint(ctx, &ctx->stack[ctx->depth - 1].cp);
+        }
+        
+        if (next_child(ctx, &ctx->stack[ctx->depth - 1])) {
+            ctx->descend = true;
+            continue;
+        }
+        
+        backtrack(ctx);
+        if (ctx->depth == 0) {
+            return SOLVE_COMPLETE;
+        }
+        restore_checkpoint(ctx, &ctx->stack[ctx->depth - 1].cp);
+    }
+}
+
+uint64_t solver_constraint_mask(const Constraint* c, int width, int height) {
+    uint64_t mask = 0;
+    
+    switch (c->type) {
+        case CONSTRAINT_GLOBAL:
+            for (int idx = 0; idx < width * height; idx++) {
+                mask |= (1ULL << idx);
+            }
+            break;
+            
+        case CONSTRAINT_ROW:
+            for (int x = 0; x < width; x++) {
+                mask |= (1ULL << cell_index(x, c->index, width));
+            }
+            break;
+            
+        case CONSTRAINT_COLUMN:
+            for (int y = 0; y < height; y++) {
+                mask |= (1ULL << cell_index(c->index, y, width));
+            }
+            break;
+            
+        case CONSTRAINT_CELL:
+            mask = 1ULL << cell_index(c->cell_x, c->cell_y, width);
+            break;
+    }
+    return mask;
+}
+
+/**
+ * Pre-compute cell masks for each constraint
+ */
+void solver_precompute_masks(Puzzle* puzzle) {
+    for (int i = 0; i < puzzle->num_constraints; i++) {
+        Constraint* c = &puzzle->constraints[i];
+        c->cell_mask = solver_constraint_mask(c, puzzle->width, puzzle->height);
+    }
+}
+
+/**
+ * Set up a search of puzzle on ctx without touching its cache or memo.
+ * Entries left by an earlier search stay valid only if it had the same
+ * constraints (the board may differ): both tables key nodes by decided
+ * cells and residual counts, never by the search that produced them.
+ */
+static bool begin_search(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions,
+                         const SolverLimits* limits) {
+    // Ensure masks are computed
+    solver_precompute_masks(puzzle);
+    reset_search_stats(ctx);
+    
+    ctx->puzzle = puzzle;
+    ctx->max_solutions = max_solutions;
+    ctx->depth = 0;
+    ctx->time_ms = 0;
+    
+    ctx->limits = limits ? *limits : (SolverLimits){0};
+    if (ctx->limits.max_states == 0) {
+        ctx->limits.max_states = UINT64_MAX;
+    }
+    
+    // Load the input board into the bitboard planes
+    load_planes(ctx->planes, puzzle->board, puzzle->width * puzzle->height);
+    
+    // Presolve the constraints into lanes, then initialize domains (and
+    // the open mask) before the counters read it
+    bool feasible = compile_lanes(ctx);
+    init_domains(ctx);
+    init_counters(ctx);
+    ctx->hash = compute_hash(ctx);
+    
+    // Later nodes only re-check the lanes their cell touches, so the root
+    // is checked and propagated over every lane once
+    uint32_t all_lanes = (ctx->num_lanes >= 32) ? UINT32_MAX : (1U << ctx->num_lanes) - 1;
+    ctx->descend = feasible && !has_violated_constraint(ctx) && propagate(ctx, all_lanes);
+    
+    if (ctx->descend && ctx->probe_ms > 0) {
+        double probe_start = solver_now_ms();
+        double deadline = probe_start + ctx->probe_ms;
+        if (ctx->limits.deadline_ms > 0 && ctx->limits.deadline_ms < deadline) {
+            deadline = ctx->limits.deadline_ms;
+        }
+        ctx->descend = probe_root(ctx, deadline);
+        ctx->time_ms = solver_now_ms() - probe_start;
+    }
+    ctx->status = ctx->descend ? SOLVE_IN_PROGRESS : SOLVE_COMPLETE;
+    return !ctx->descend;
+}
+
+bool solver_begin(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions,
+                  const SolverLimits* limits) {
+    solver_context_reset(ctx);
+    return begin_search(ctx, puzzle, max_solutions, limits);
+}
+
+bool solver_step(SolverContext* ctx, uint64_t max_nodes) {
+    if (ctx->status != SOLVE_IN_PROGRESS) {
+        return true;
+    }
+    
+    clock_t start = clock();
+    ctx->status = search(ctx, max_nodes);
     clock_t end = clock();
     
-    // Populate result
+    ctx->time_ms += ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    return ctx->status != SOLVE_IN_PROGRESS;
+}
+
+SolverResult solver_get_result(const SolverContext* ctx) {
+    SolverResult result = {0};
     result.solution_count = ctx->solution_count;
     result.states_explored = ctx->states_explored;
-    result.time_ms = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    result.time_ms = ctx->time_ms;
     result.is_solvable = ctx->solution_count > 0;
+    result.cache_hits = ctx->tt_hits;
+    result.cache_misses = ctx->tt_misses;
+    result.status = ctx->status;
+    result.num_witnesses = ctx->num_witnesses;
+    memcpy(result.witnesses, ctx->witnesses, sizeof(result.witnesses));
+    return result;
+}
+
+SolverResult solver_solve_ex(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions,
+                             const SolverLimits* limits) {
+    SolverResult result = {0};
+    bool own_context = (ctx == NULL);
+    
+    if (!own_context && ctx->engine == SOLVER_ENGINE_ROWS) {
+        return solver_solve_rows_in(&ctx->rows, puzzle, max_solutions, limits);
+    }
+    
+    // Auto: whole rows first, unless row counts alone prune too weakly for
+    // this puzzle (typically global constraints that only propagation
+    // relates to each other)
+    SolverLimits cell_limits = limits ? *limits : (SolverLimits){0};
+    uint64_t row_states = 0;
+    if (!own_context && ctx->engine == SOLVER_ENGINE_AUTO &&
+        puzzle->width * puzzle->height >= ROW_ENGINE_MIN_CELLS) {
+        SolverLimits trial = cell_limits;
+        bool capped = trial.max_states == 0 || trial.max_states > ROW_ENGINE_TRIAL_STATES;
+        if (capped) {
+            trial.max_states = ROW_ENGINE_TRIAL_STATES;
+        }
+        
+        SolverResult rows = solver_solve_rows_in(&ctx->rows, puzzle, max_solutions, &trial);
+        if (!capped || rows.status != SOLVE_BUDGET_EXHAUSTED) {
+            return rows;
+        }
+        row_states = rows.states_explored;
+        if (cell_limits.max_states > 0) {
+            cell_limits.max_states -= row_states;
+        }
+    }
+    
+    // Create or reuse context
+    if (own_context) {
+        ctx = solver_context_create();
+        if (!ctx) return result;
+    }
+    
+    solver_begin(ctx, puzzle, max_solutions, &cell_limits);
+    solver_step(ctx, UINT64_MAX);
+    result = solver_get_result(ctx);
+    result.states_explored += row_states;
+    
+    if (own_context) {
+        solver_context_destroy(ctx);
+    }
+    
+    return result;
+}
+
+SolverResult solver_enumerate(SolverContext* ctx, Puzzle* puzzle,
+                              SolverSolutionCallback callback, void* user,
+                              const SolverLimits* limits) {
+    SolverResult result = {0};
+    bool own_context = (ctx == NULL);
+    
+    if (own_context) {
+        ctx = solver_context_create();
+        if (!ctx) return result;
+    }
+    
+    solver_begin(ctx, puzzle, 0, limits);
+    ctx->callback = callback;
+    ctx->callback_user = user;
+    solver_step(ctx, UINT64_MAX);
+    ctx->callback = NULL;
+    result = solver_get_result(ctx);
     
     if (own_context) {
         solver_context_destroy(ctx);
@@ -506,31 +1609,521 @@ SolverResult solver_solve_ex(SolverContext* ctx, Puzzle* puzzle, uint64_t max_so
  * Main solve function (legacy API)
  */
 SolverResult solver_solve(Puzzle* puzzle, bool find_first) {
-    return solver_solve_ex(NULL, puzzle, find_first ? 1 : 0);
+    return solver_solve_ex(NULL, puzzle, find_first ? 1 : 0, NULL);
 }
 
 bool solver_is_solvable(Puzzle* puzzle) {
-    SolverResult result = solver_solve_ex(NULL, puzzle, 1);
+    SolverResult result = solver_solve_ex(NULL, puzzle, 1, NULL);
     return result.is_solvable;
 }
 
 bool solver_has_unique_solution(Puzzle* puzzle) {
     // Stop at 2 - if we find more than 1, we know it's not unique
-    SolverResult result = solver_solve_ex(NULL, puzzle, 2);
+    SolverResult result = solver_solve_ex(NULL, puzzle, 2, NULL);
     return result.solution_count == 1;
 }
 
 bool solver_has_unique_solution_ex(SolverContext* ctx, Puzzle* puzzle) {
     // Stop at 2 - if we find more than 1, we know it's not unique
-    SolverResult result = solver_solve_ex(ctx, puzzle, 2);
+    SolverResult result = solver_solve_ex(ctx, puzzle, 2, NULL);
     return result.solution_count == 1;
 }
 
 uint64_t solver_count_solutions(Puzzle* puzzle) {
-    SolverResult result = solver_solve_ex(NULL, puzzle, 0);
+    SolverResult result = solver_solve_ex(NULL, puzzle, 0, NULL);
     return result.solution_count;
 }
 
+/**
+ * Parallel counting
+ * 
+ * The tree is expanded breadth-limited to split_depth branching levels.
+ * Every node at that depth becomes an independent subproblem: the puzzle
+ * with the path's decisions (and everything propagation fixed) written
+ * into the board and locked. Solutions above the split depth are counted
+ * while expanding. Subproblems with the same residual key (see
+ * residual_key) have the same count, so each is counted once and weighted
+ * by how often it came up. Workers then count subproblems with their own
+ * contexts, whose cache and memo start as copies of the splitting
+ * context's (filled by the trial search at automatic depth) and carry over
+ * from one subproblem to the next. The totals are summed, so the result
+ * equals the serial count.
+ */
+typedef struct {
+    uint8_t board[MAX_CELLS];
+    uint64_t locked_mask;
+    uint64_t key;     // Residual key of the subproblem's root
+    uint64_t weight;  // Number of frontier nodes sharing that key
+} Subproblem;
+
+typedef struct {
+    Subproblem* items;
+    int count;
+    int capacity;
+    uint64_t solutions;  // Solutions found above the split depth
+} Frontier;
+
+static bool frontier_push(Frontier* frontier, const SolverContext* ctx) {
+    // A node with an unsatisfied final constraint has no completions
+    uint64_t key;
+    if (!residual_key(ctx, ctx->open, &key)) {
+        return true;
+    }
+    
+    if (frontier->count == frontier->capacity) {
+        int capacity = frontier->capacity ? frontier->capacity * 2 : 256;
+        Subproblem* items = realloc(frontier->items, capacity * sizeof(Subproblem));
+        if (!items) return false;
+        frontier->items = items;
+        frontier->capacity = capacity;
+    }
+    
+    const Puzzle* p = ctx->puzzle;
+    int total = p->width * p->height;
+    uint64_t board_mask = (total == 64) ? ~0ULL : (1ULL << total) - 1;
+    Subproblem* sub = &frontier->items[frontier->count++];
+    
+    memset(sub->board, SHAPE_CAT, sizeof(sub->board));
+    store_planes(ctx->planes, sub->board, total);
+    sub->locked_mask = board_mask & ~ctx->open;
+    sub->key = key;
+    sub->weight = 1;
+    return true;
+}
+
+static int compare_subproblems(const void* a, const void* b) {
+    uint64_t ka = ((const Subproblem*)a)->key;
+    uint64_t kb = ((const Subproblem*)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+/**
+ * Merge subproblems with the same residual key into one, summing weights
+ */
+static void merge_frontier(Frontier* frontier) {
+    if (frontier->count == 0) return;
+    qsort(frontier->items, frontier->count, sizeof(Subproblem), compare_subproblems);
+    
+    int n = 1;
+    for (int i = 1; i < frontier->count; i++) {
+        if (frontier->items[i].key == frontier->items[n - 1].key) {
+            frontier->items[n - 1].weight += frontier->items[i].weight;
+        } else {
+            frontier->items[n++] = frontier->items[i];
+        }
+    }
+    frontier->count = n;
+}
+
+/**
+ * Expand the search begun on ctx down to split_depth, collecting the
+ * frontier. No cache or memo is used: subtrees below the split are not
+ * explored here, so nothing about them is known yet.
+ */
+static bool split_frontier(SolverContext* ctx, int split_depth, Frontier* frontier) {
+    if (ctx->status != SOLVE_IN_PROGRESS) {
+        return true;
+    }
+    
+    for (;;) {
+        if (ctx->descend) {
+            ctx->descend = false;
+            
+            if (ctx->open == 0) {
+                ctx->states_explored++;
+                if (all_counters_satisfied(ctx)) frontier->solutions++;
+            } else if (ctx->depth == split_depth) {
+                if (!frontier_push(frontier, ctx)) return false;
+            } else {
+                ctx->states_explored++;
+                push_frame(ctx);
+                continue;
+            }
+            if (ctx->depth == 0) return true;
+            restore_checkpoint(ctx, &ctx->stack[ctx->depth - 1].cp);
+        }
+        
+        if (next_child(ctx, &ctx->stack[ctx->depth - 1])) {
+            ctx->descend = true;
+            continue;
+        }
+        
+        if (--ctx->depth == 0) return true;
+        restore_checkpoint(ctx, &ctx->stack[ctx->depth - 1].cp);
+    }
+}
+
+/**
+ * Per-worker queue of frontier indices [head, tail).
+ * The owner takes from the head; thieves take the back half from the tail.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    int head;
+    int tail;
+} WorkQueue;
+
+typedef struct {
+    const Puzzle* base;
+    const SolverContext* seed;
+    const Frontier* frontier;
+    WorkQueue* queues;
+    int num_workers;
+    int id;
+    uint64_t solutions;
+    uint64_t states;
+    int done;            // Subproblems counted
+    SolveStatus status;  // First subproblem that did not complete, if any
+} CountWorker;
+
+static bool take_work(CountWorker* w, int* index) {
+    WorkQueue* own = &w->queues[w->id];
+    
+    pthread_mutex_lock(&own->lock);
+    bool found = own->head < own->tail;
+    if (found) *index = own->head++;
+    pthread_mutex_unlock(&own->lock);
+    if (found) return true;
+    
+    // Own queue is empty: steal half of the first non-empty victim
+    for (int k = 1; k < w->num_workers; k++) {
+        WorkQueue* victim = &w->queues[(w->id + k) % w->num_workers];
+        
+        pthread_mutex_lock(&victim->lock);
+        int available = victim->tail - victim->head;
+        int stolen = (available + 1) / 2;
+        victim->tail -= stolen;
+        int begin = victim->tail;
+        pthread_mutex_unlock(&victim->lock);
+        
+        if (stolen > 0) {
+            *index = begin;
+            pthread_mutex_lock(&own->lock);
+            own->head = begin + 1;
+            own->tail = begin + stolen;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Count queued subproblems on ctx until the queues are empty
+ */
+static void count_queued(CountWorker* w, SolverContext* ctx) {
+    Puzzle puzzle = *w->base;
+    int index;
+    while (w->status == SOLVE_COMPLETE && take_work(w, &index)) {
+        const Subproblem* sub = &w->frontier->items[index];
+        memcpy(puzzle.board, sub->board, sizeof(puzzle.board));
+        puzzle.locked_mask = sub->locked_mask;
+        
+        begin_search(ctx, &puzzle, 0, NULL);
+        ctx->num_witnesses = SOLVER_MAX_WITNESSES;  // Counts only: memo hits from the start
+        solver_step(ctx, UINT64_MAX);
+        w->solutions += ctx->solution_count * sub->weight;
+        w->states += ctx->states_explored;
+        w->done++;
+        w->status = ctx->status;
+    }
+}
+
+static void* count_worker(void* arg) {
+    CountWorker* w = (CountWorker*)arg;
+    
+    // Without a context this worker takes nothing; the others steal its queue
+    SolverContext* ctx = solver_context_create();
+    if (!ctx) return NULL;
+    
+    // Subproblems only differ from the puzzle in their boards, so entries
+    // from the trial search and from earlier subproblems carry over
+    size_t buckets = w->seed->tt_bucket_mask + 1;
+    memcpy(ctx->tt, w->seed->tt, buckets * sizeof(TTBucket));
+    memcpy(ctx->memo, w->seed->memo, buckets * sizeof(MemoBucket));
+    ctx->tt_generation = w->seed->tt_generation;
+    
+    count_queued(w, ctx);
+    solver_context_destroy(ctx);
+    return NULL;
+}
+
+SolverResult solver_count_solutions_parallel(Puzzle* puzzle, int num_threads, int split_depth) {
+    if (num_threads <= 1) {
+        return solver_solve_ex(NULL, puzzle, 0, NULL);
+    }
+    if (num_threads > SOLVER_MAX_THREADS) num_threads = SOLVER_MAX_THREADS;
+    
+    SolverResult result = {0};
+    double start = solver_now_ms();
+    
+    SolverContext* ctx = solver_context_create();
+    if (!ctx) return result;
+    
+    // Automatic depth: small counts finish serially before splitting would
+    // pay for itself. Otherwise deepen until there are several subproblems
+    // per thread.
+    bool auto_depth = (split_depth <= 0);
+    uint64_t trial_states = 0;
+    if (auto_depth) {
+        SolverLimits trial = {.max_states = PARALLEL_TRIAL_STATES};
+        solver_begin(ctx, puzzle, 0, &trial);
+        solver_step(ctx, UINT64_MAX);
+        if (ctx->status != SOLVE_BUDGET_EXHAUSTED) {
+            result = solver_get_result(ctx);
+            result.time_ms = solver_now_ms() - start;
+            solver_context_destroy(ctx);
+            return result;
+        }
+        trial_states = ctx->states_explored;
+        split_depth = 2;
+    }
+    
+    Frontier frontier = {0};
+    for (;;) {
+        frontier.count = 0;
+        frontier.solutions = 0;
+        begin_search(ctx, puzzle, 0, NULL);
+        if (!split_frontier(ctx, split_depth, &frontier)) {
+            free(frontier.items);
+            solver_context_destroy(ctx);
+            return solver_solve_ex(NULL, puzzle, 0, NULL);
+        }
+        merge_frontier(&frontier);
+        if (!auto_depth || frontier.count >= num_threads * SPLIT_TASKS_PER_THREAD ||
+            split_depth >= MAX_CELLS || frontier.count == 0) {
+            break;
+        }
+        split_depth++;
+    }
+    
+    uint64_t solutions = frontier.solutions;
+    uint64_t states = trial_states + ctx->states_explored;
+    
+    // Deal the frontier out in contiguous runs, one queue per worker
+    WorkQueue queues[SOLVER_MAX_THREADS];
+    CountWorker workers[SOLVER_MAX_THREADS];
+    pthread_t threads[SOLVER_MAX_THREADS];
+    
+    for (int i = 0; i < num_threads; i++) {
+        pthread_mutex_init(&queues[i].lock, NULL);
+        queues[i].head = (int)((int64_t)frontier.count * i / num_threads);
+        queues[i].tail = (int)((int64_t)frontier.count * (i + 1) / num_threads);
+        
+        workers[i] = (CountWorker){
+            .base = puzzle,
+            .seed = ctx,
+            .frontier = &frontier,
+            .queues = queues,
+            .num_workers = num_threads,
+            .id = i,
+            .status = SOLVE_COMPLETE
+        };
+    }
+    
+    int started = 0;
+    while (started < num_threads &&
+           pthread_create(&threads[started], NULL, count_worker, &workers[started]) == 0) {
+        started++;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    
+    result.status = SOLVE_COMPLETE;
+    for (int i = 0; i < num_threads; i++) {
+        if (workers[i].status != SOLVE_COMPLETE) result.status = workers[i].status;
+    }
+    
+    // Whatever is left (threads that did not start or could not allocate a
+    // context) is counted here, on the splitting context
+    if (result.status == SOLVE_COMPLETE) {
+        count_queued(&workers[0], ctx);
+        result.status = workers[0].status;
+    }
+    
+    int done = 0;
+    for (int i = 0; i < num_threads; i++) {
+        solutions += workers[i].solutions;
+        states += workers[i].states;
+        done += workers[i].done;
+    }
+    assert(result.status != SOLVE_COMPLETE || done == frontier.count);
+    
+    // Thieves touch every queue, so locks go only once all workers are done
+    for (int i = 0; i < num_threads; i++) {
+        pthread_mutex_destroy(&queues[i].lock);
+    }
+    
+    free(frontier.items);
+    solver_context_destroy(ctx);
+    
+    result.solution_count = solutions;
+    result.states_explored = states;
+    result.time_ms = solver_now_ms() - start;
+    result.is_solvable = solutions > 0;
+    return result;
+}
+
 bool solver_validate(const Puzzle* puzzle) {
-    return all_constraints_satisfied(puzzle);
+    uint64_t planes[SHAPE_COUNT];
+    load_planes(planes, puzzle->board, puzzle->width * puzzle->height);
+    return all_constraints_satisfied(puzzle, planes);
+}
+
+/**
+ * Split a flat board into shape planes for batch validation.
+ * Returns false if any cell holds a value that is not a shape.
+ */
+static inline bool board_to_planes(const uint8_t* board, int total, uint64_t board_mask,
+                                   uint64_t* planes) {
+    int start = 0;
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        planes[s] = 0;
+    }
+    
+#ifdef __AVX2__
+    // First 32 cells: one compare + movemask per shape
+    // (MAX_CELLS >= 32, so the load stays inside the board)
+    __m256i cells = _mm256_loadu_si256((const __m256i*)board);
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        __m256i hits = _mm256_cmpeq_epi8(cells, _mm256_set1_epi8((char)s));
+        planes[s] = (uint32_t)_mm256_movemask_epi8(hits);
+    }
+    start = 32;
+#endif
+    
+    for (int i = start; i < total; i++) {
+        if (board[i] < SHAPE_COUNT) {
+            planes[board[i]] |= 1ULL << i;
+        }
+    }
+    
+    uint64_t seen = 0;
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        planes[s] &= board_mask;
+        seen |= planes[s];
+    }
+    return seen == board_mask;
+}
+
+size_t solver_validate_batch(const Puzzle* puzzle, const uint8_t (*boards)[MAX_CELLS],
+                             size_t num_boards, bool* valid) {
+    int total = puzzle->width * puzzle->height;
+    uint64_t board_mask = (total == 64) ? ~0ULL : (1ULL << total) - 1;
+    
+    // Compile the constraints once for the whole batch: region, shape,
+    // and the [lo, hi] its count must hit
+    // ([lo, hi] is kept as lo and hi - lo for a single unsigned compare)
+    int n = puzzle->num_constraints;
+    uint64_t masks[MAX_CONSTRAINTS];
+    uint8_t shapes[MAX_CONSTRAINTS];
+    uint32_t lo[MAX_CONSTRAINTS];
+    uint32_t span[MAX_CONSTRAINTS];
+    
+    for (int i = 0; i < n; i++) {
+        const Constraint* c = &puzzle->constraints[i];
+        uint8_t c_lo, c_hi;
+        masks[i] = (c->type == CONSTRAINT_CELL) ?
+                   1ULL << cell_index(c->cell_x, c->cell_y, puzzle->width) : c->cell_mask;
+        shapes[i] = c->shape;
+        solver_constraint_bounds(c, &c_lo, &c_hi);
+        if (c_lo <= c_hi) {
+            lo[i] = c_lo;
+            span[i] = c_hi - c_lo;
+        } else {
+            lo[i] = UINT32_MAX;  // count - lo >= 1 > span: never satisfied
+            span[i] = 0;
+        }
+    }
+    
+    size_t num_valid = 0;
+    for (size_t b = 0; b < num_boards; b++) {
+        uint64_t planes[SHAPE_COUNT];
+        bool ok = board_to_planes(boards[b], total, board_mask, planes);
+        
+        // Cells counting towards a constraint on each shape (Cat counts
+        // for every shape)
+        uint64_t counted[SHAPE_COUNT];
+        counted[SHAPE_CAT] = planes[SHAPE_CAT];
+        for (int s = SHAPE_SQUARE; s < SHAPE_COUNT; s++) {
+            counted[s] = planes[s] | planes[SHAPE_CAT];
+        }
+        
+        // Branch-free over the constraints so boards stream through
+        for (int i = 0; i < n; i++) {
+            uint32_t count = __builtin_popcountll(masks[i] & counted[shapes[i]]);
+            ok &= (count - lo[i]) <= span[i];
+        }
+        
+        if (valid) valid[b] = ok;
+        num_valid += ok;
+    }
+    return num_valid;
+}
+
+void solver_session_init(SolverSession* session, SolverContext* ctx, Puzzle* puzzle) {
+    memset(session, 0, sizeof(*session));
+    session->ctx = ctx;
+    session->puzzle = puzzle;
+}
+
+void solver_session_add_board(SolverSession* session, const uint8_t* board) {
+    int total = session->puzzle->width * session->puzzle->height;
+    for (int b = 0; b < session->num_boards; b++) {
+        if (memcmp(session->boards[b], board, total) == 0) return;
+    }
+    
+    uint8_t* slot = session->boards[session->next_board];
+    memset(slot, SHAPE_CAT, MAX_CELLS);
+    memcpy(slot, board, total);
+    session->next_board = (session->next_board + 1) % SOLVER_SESSION_BOARDS;
+    if (session->num_boards < SOLVER_SESSION_BOARDS) {
+        session->num_boards++;
+    }
+}
+
+/**
+ * True if board keeps every cell the puzzle fixes (locked cells and
+ * concrete input cells)
+ */
+static bool board_keeps_fixed_cells(const Puzzle* puzzle, const uint8_t* board) {
+    for (int i = 0; i < puzzle->width * puzzle->height; i++) {
+        bool open = puzzle->board[i] == SHAPE_CAT && !(puzzle->locked_mask & (1ULL << i));
+        if (!open && board[i] != puzzle->board[i]) return false;
+    }
+    return true;
+}
+
+SolverResult solver_session_check(SolverSession* session) {
+    Puzzle* puzzle = session->puzzle;
+    int total = puzzle->width * puzzle->height;
+    SolverResult result = {0};
+    
+    solver_precompute_masks(puzzle);
+    bool valid[SOLVER_SESSION_BOARDS];
+    solver_validate_batch(puzzle, (const uint8_t (*)[MAX_CELLS])session->boards,
+                          session->num_boards, valid);
+    
+    for (int b = 0; b < session->num_boards && result.num_witnesses < 2; b++) {
+        if (valid[b] && board_keeps_fixed_cells(puzzle, session->boards[b])) {
+            memcpy(result.witnesses[result.num_witnesses++], session->boards[b], total);
+        }
+    }
+    
+    // Two known solutions still hold: at least 2, nothing to search
+    if (result.num_witnesses == 2) {
+        result.solution_count = 2;
+        result.is_solvable = true;
+        result.status = SOLVE_COMPLETE;
+        session->shortcuts++;
+        return result;
+    }
+    
+    result = solver_solve_ex(session->ctx, puzzle, 2, session->limits);
+    session->searches++;
+    for (int w = 0; w < result.num_witnesses; w++) {
+        solver_session_add_board(session, result.witnesses[w]);
+    }
+    return result;
 }
@@ -2,7 +2,8 @@
  * Schrödinger's Shapes - High Performance Solver
  * 
  * Backtracking solver with aggressive optimizations:
- * - Flat array board representation
+ * - Explicit-stack search that can be paused and resumed
+ * - Bitboard board representation (one plane per shape)
  * - Bitmask-based constraint checking
  * - Early pruning on constraint violations
  * - State caching with efficient hashing
@@ -15,23 +16,94 @@
 #define SOLVER_H
 
 #include "types.h"
+#include <stdatomic.h>
 
 // Forward declaration
 typedef struct SolverContext SolverContext;
 
+// Upper bound on worker threads for parallel counting
+#define SOLVER_MAX_THREADS 64
+
+/**
+ * Branching order for the search (set per context, see below)
+ */
+typedef enum {
+    SOLVER_ORDER_STATIC,            // Next open cell in row-major order
+    SOLVER_ORDER_MOST_CONSTRAINED   // Smallest live domain, tightest constraints
+} SolverOrdering;
+
+/**
+ * Optional bounds on a single solve (zero-initialize for "no limit")
+ * 
+ * A solve that hits a limit stops between nodes and reports
+ * SOLVE_BUDGET_EXHAUSTED or SOLVE_CANCELLED; its solution_count is then
+ * only a lower bound.
+ */
+typedef struct {
+    uint64_t max_states;        // Stop after this many states (0 = unlimited)
+    double deadline_ms;         // Stop at this solver_now_ms() time (0 = none)
+    const atomic_bool* cancel;  // Stop once another thread sets this (NULL = none)
+} SolverLimits;
+
+/**
+ * Monotonic clock in milliseconds, for SolverLimits.deadline_ms
+ */
+double solver_now_ms(void);
+
+/**
+ * Search engine used by solver_solve_ex() (set per context, see below)
+ */
+typedef enum {
+    SOLVER_ENGINE_CELLS,  // Cell-by-cell search with propagation
+    SOLVER_ENGINE_ROWS,   // Whole-row search over per-row pattern tables
+    SOLVER_ENGINE_AUTO    // Rows on boards of 25+ cells, falling back to
+                          // cells if a short row search does not finish
+} SolverEngine;
+
 /**
  * Create a reusable solver context
  * This avoids repeated memory allocation for the cache
  */
 SolverContext* solver_context_create(void);
 
+/**
+ * Create a solver context with a transposition table of about cache_bytes
+ * (rounded down to a power-of-two number of 64-byte buckets)
+ * Use SolverResult.cache_hits/cache_misses to tune the size per level.
+ */
+SolverContext* solver_context_create_sized(size_t cache_bytes);
+
 /**
  * Destroy a solver context
  */
 void solver_context_destroy(SolverContext* ctx);
 
 /**
- * Reset solver context for a new solve (clears cache)
+ * Select the branching order used by later solves on this context
+ * (default SOLVER_ORDER_STATIC). Results are identical; only the
+ * number of states explored changes.
+ */
+void solver_context_set_ordering(SolverContext* ctx, SolverOrdering ordering);
+
+/**
+ * Select the engine for later solver_solve_ex() calls on this context
+ * (default SOLVER_ENGINE_CELLS). Both engines give identical counts; the
+ * row engine ignores the branching order and is not resumable, so
+ * solver_begin()/solver_step() and solver_enumerate() always use cells.
+ */
+void solver_context_set_engine(SolverContext* ctx, SolverEngine engine);
+
+/**
+ * Enable failed-literal probing for later cell-engine solves on this
+ * context: before branching, every (cell, shape) still possible at the
+ * root is tried with propagation and removed if it fails at once,
+ * repeating until nothing changes or time_limit_ms has passed (0 turns
+ * probing off, the default). Solution counts are unaffected.
+ */
+void solver_context_set_probing(SolverContext* ctx, double time_limit_ms);
+
+/**
+ * Reset solver context for a new solve (invalidates cache in O(1))
  */
 void solver_context_reset(SolverContext* ctx);
 
@@ -39,11 +111,64 @@ void solver_context_reset(SolverContext* ctx);
  * Solve the puzzle with a reusable context
  * 
  * @param ctx          Reusable solver context (or NULL to allocate internally)
- * @param puzzle       The puzzle to solve (board will be modified during solve)
+ * @param puzzle       The puzzle to solve (board is read as the initial state)
  * @param max_solutions Stop after finding this many solutions (0 = find all)
+ * @param limits       Budget/deadline/cancellation (or NULL for none)
  * @return             Solver result with solution count and statistics
  */
-SolverResult solver_solve_ex(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions);
+SolverResult solver_solve_ex(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions,
+                             const SolverLimits* limits);
+
+/**
+ * Called with each solution board (width * height cells, read-only and
+ * only valid during the call) in search order. Return false to stop.
+ */
+typedef bool (*SolverSolutionCallback)(const uint8_t* board, void* user);
+
+/**
+ * Visit every solution of the puzzle
+ * 
+ * @param ctx       Reusable solver context (or NULL to allocate internally)
+ * @param puzzle    The puzzle to solve
+ * @param callback  Called once per solution; returning false stops the search
+ * @param user      Passed through to the callback
+ * @param limits    Budget/deadline/cancellation (or NULL for none)
+ * @return          Solutions visited and statistics
+ */
+SolverResult solver_enumerate(SolverContext* ctx, Puzzle* puzzle,
+                              SolverSolutionCallback callback, void* user,
+                              const SolverLimits* limits);
+
+/**
+ * Resumable solving: solver_begin() sets up a search on ctx, each
+ * solver_step() advances it by at most max_nodes states, and
+ * solver_get_result() reports progress so far. Many solves can be
+ * interleaved on one thread by giving each its own context. The puzzle
+ * must outlive the search, and ctx must not start another solve
+ * (including solver_solve_ex) until this one is finished or abandoned.
+ * 
+ * solver_begin() and solver_step() return true once the search has
+ * stopped for good: finished, out of budget or cancelled (see
+ * SolverResult.status). max_nodes only pauses the search.
+ */
+bool solver_begin(SolverContext* ctx, Puzzle* puzzle, uint64_t max_solutions,
+                  const SolverLimits* limits);
+bool solver_step(SolverContext* ctx, uint64_t max_nodes);
+SolverResult solver_get_result(const SolverContext* ctx);
+
+/**
+ * Solve with the row-pattern engine directly (see solver_rows.c)
+ */
+SolverResult solver_solve_rows(Puzzle* puzzle, uint64_t max_solutions,
+                               const SolverLimits* limits);
+
+/**
+ * Same, reusing the row tables and memo in *workspace across solves
+ * (allocated on first use if *workspace is NULL; release with free()).
+ * Solver contexts keep one for their row-engine solves.
+ */
+SolverResult solver_solve_rows_in(void** workspace, Puzzle* puzzle, uint64_t max_solutions,
+                                  const SolverLimits* limits);
 
 /**
  * Solve the puzzle and count solutions (legacy API)
@@ -75,11 +200,104 @@ bool solver_has_unique_solution_ex(SolverContext* ctx, Puzzle* puzzle);
  */
 uint64_t solver_count_solutions(Puzzle* puzzle);
 
+/**
+ * Count all solutions on num_threads threads
+ * 
+ * The search tree is split split_depth branching levels below the root
+ * (0 = automatic: counts that a short serial search finishes are returned
+ * as they are, larger ones are split deep enough to give every thread
+ * several subproblems); threads count the subproblems with work stealing
+ * and the counts are summed.
+ * The count is identical to solver_count_solutions(); witness boards are
+ * not collected. With num_threads <= 1 this is a plain serial solve.
+ */
+SolverResult solver_count_solutions_parallel(Puzzle* puzzle, int num_threads, int split_depth);
+
+/**
+ * Exact solution count (128-bit: an unconstrained 6x6 board has 4^36)
+ */
+typedef unsigned __int128 SolverCount;
+
+/**
+ * Count solutions by row-profile dynamic programming (see solver_dp.c)
+ * 
+ * Gives the same answer as solver_count_solutions() without visiting
+ * solutions one by one. Returns false if the profile space grows past
+ * its limit, in which case *count is untouched.
+ */
+bool solver_count_solutions_dp(Puzzle* puzzle, SolverCount* count);
+
 /**
  * Validate that current board state satisfies all constraints
  */
 bool solver_validate(const Puzzle* puzzle);
 
+/**
+ * Validate many boards against the same puzzle
+ * 
+ * Each boards[b] is a flat board laid out like Puzzle.board. Cells holding
+ * a value that is not a shape make the board invalid.
+ * 
+ * @param valid  Per-board results (may be NULL)
+ * @return       Number of valid boards
+ */
+size_t solver_validate_batch(const Puzzle* puzzle, const uint8_t (*boards)[MAX_CELLS],
+                             size_t num_boards, bool* valid);
+
+/**
+ * Incremental uniqueness checking
+ * 
+ * A session answers "how many solutions, up to 2" for a puzzle whose
+ * constraints change between checks, typically one appended at a time.
+ * It remembers the solution boards found so far (by its searches, or
+ * handed in with solver_session_add_board) and a check first validates
+ * those against the current puzzle: while two still hold, the answer is
+ * 2 without searching. Adding a constraint can only remove solutions, so
+ * this stays true until one of the known boards is eliminated. Removing
+ * constraints is fine too; known boards are simply re-validated.
+ */
+#define SOLVER_SESSION_BOARDS 8
+
+typedef struct {
+    SolverContext* ctx;   // Used for searches (not owned)
+    Puzzle* puzzle;       // Checked in its current state (not owned)
+    const SolverLimits* limits;  // Applied to searches (NULL = none; set after init)
+    int num_boards;
+    int next_board;       // Ring slot the next new board replaces
+    uint8_t boards[SOLVER_SESSION_BOARDS][MAX_CELLS];
+    uint64_t searches;    // Checks that needed a search
+    uint64_t shortcuts;   // Checks answered from known boards
+} SolverSession;
+
+void solver_session_init(SolverSession* session, SolverContext* ctx, Puzzle* puzzle);
+
+/**
+ * Remember a board that may solve the puzzle (checked on use, so a board
+ * that does not is harmless)
+ */
+void solver_session_add_board(SolverSession* session, const uint8_t* board);
+
+/**
+ * Same solution count as solver_solve_ex(ctx, puzzle, 2, limits) for the
+ * session's puzzle as it is now. The witnesses are valid solutions, though
+ * not necessarily the first ones a fresh search would find.
+ */
+SolverResult solver_session_check(SolverSession* session);
+
+/**
+ * Normalize a constraint to the interval [lo, hi] that the number of
+ * counting cells in its region must fall in (Cat cells count towards
+ * every non-cat shape; IS is [1, 1], IS_NOT and NONE are [0, 0]).
+ * Unknown operators give an empty interval (lo > hi).
+ */
+void solver_constraint_bounds(const Constraint* c, uint8_t* lo, uint8_t* hi);
+
+/**
+ * Cells of a constraint's region on a width x height board, as a bitmask
+ * with bit y * width + x for cell (x, y)
+ */
+uint64_t solver_constraint_mask(const Constraint* c, int width, int height);
+
 /**
  * Pre-compute constraint cell masks (call after setting up puzzle)
  */
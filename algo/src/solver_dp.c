@@ -0,0 +1,296 @@
+/**
+ * Schrödinger's Shapes - Row-Profile DP Model Counter
+ * 
+ * Counts solutions exactly without visiting them, by sweeping the board
+ * one row at a time:
+ * 1. Constraints whose region lies inside one row (row and cell
+ *    constraints) are checked while enumerating that row's patterns
+ * 2. Every other constraint (columns, global) is carried across rows as
+ *    a running count; the vector of carried counts is the DP profile
+ * 3. Row patterns with the same effect on the profile are merged into one
+ *    class with a multiplicity, so a transition is (profile x class)
+ * 
+ * Profiles whose counts already exceed a bound, or can no longer reach
+ * one with the cells left below, are dropped. Counts are 128-bit.
+ */
+
+#include "solver.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Give up (and let the caller fall back) beyond this many live profiles
+#define DP_MAX_PROFILES (1u << 20)
+
+/**
+ * Hash map from a fixed-length byte key to a 128-bit count
+ * 
+ * Entries live in flat arrays (key stride rounded up to 8 bytes, zero
+ * padded) and an open-addressed slot table stores entry index + 1.
+ */
+typedef struct {
+    int stride;
+    uint32_t size;
+    uint32_t capacity;
+    uint8_t* keys;
+    SolverCount* counts;
+    uint32_t* slots;
+    uint32_t slot_mask;
+} ProfileMap;
+
+static uint64_t hash_key(const uint8_t* key, int stride) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < stride; i += 8) {
+        uint64_t word;
+        memcpy(&word, key + i, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static bool map_init(ProfileMap* m, int stride) {
+    memset(m, 0, sizeof(*m));
+    m->stride = stride;
+    m->capacity = 64;
+    m->slot_mask = 127;
+    m->keys = malloc((size_t)m->capacity * stride);
+    m->counts = malloc(m->capacity * sizeof(SolverCount));
+    m->slots = calloc(m->slot_mask + 1, sizeof(uint32_t));
+    return m->keys && m->counts && m->slots;
+}
+
+static void map_free(ProfileMap* m) {
+    free(m->keys);
+    free(m->counts);
+    free(m->slots);
+    memset(m, 0, sizeof(*m));
+}
+
+static void map_clear(ProfileMap* m) {
+    m->size = 0;
+    memset(m->slots, 0, (m->slot_mask + 1) * sizeof(uint32_t));
+}
+
+static bool map_grow_slots(ProfileMap* m) {
+    uint32_t slot_mask = m->slot_mask * 2 + 1;
+    uint32_t* slots = calloc(slot_mask + 1, sizeof(uint32_t));
+    if (!slots) return false;
+    
+    for (uint32_t e = 0; e < m->size; e++) {
+        uint32_t slot = hash_key(m->keys + (size_t)e * m->stride, m->stride) & slot_mask;
+        while (slots[slot]) slot = (slot + 1) & slot_mask;
+        slots[slot] = e + 1;
+    }
+    free(m->slots);
+    m->slots = slots;
+    m->slot_mask = slot_mask;
+    return true;
+}
+
+/**
+ * Add count to the entry for key, creating it if needed
+ */
+static bool map_add(ProfileMap* m, const uint8_t* key, SolverCount count) {
+    uint32_t slot = hash_key(key, m->stride) & m->slot_mask;
+    while (m->slots[slot]) {
+        uint32_t e = m->slots[slot] - 1;
+        if (memcmp(m->keys + (size_t)e * m->stride, key, m->stride) == 0) {
+            m->counts[e] += count;
+            return true;
+        }
+        slot = (slot + 1) & m->slot_mask;
+    }
+    
+    if (m->size == m->capacity) {
+        uint32_t capacity = m->capacity * 2;
+        uint8_t* keys = realloc(m->keys, (size_t)capacity * m->stride);
+        if (!keys) return false;
+        m->keys = keys;
+        SolverCount* counts = realloc(m->counts, capacity * sizeof(SolverCount));
+        if (!counts) return false;
+        m->counts = counts;
+        m->capacity = capacity;
+    }
+    
+    uint32_t e = m->size++;
+    memcpy(m->keys + (size_t)e * m->stride, key, m->stride);
+    m->counts[e] = count;
+    m->slots[slot] = e + 1;
+    
+    // Keep the slot table at most half full
+    if (m->size * 2 > m->slot_mask + 1) {
+        return map_grow_slots(m);
+    }
+    return true;
+}
+
+/**
+ * Constraint list split for the sweep
+ */
+typedef struct {
+    int width;
+    int height;
+    uint64_t domains[SHAPE_COUNT];  // Bit i set if cell i may take shape s
+    
+    // Row-local constraints, checked inside pattern enumeration
+    int num_local;
+    uint64_t local_masks[MAX_CONSTRAINTS];
+    uint8_t local_shapes[MAX_CONSTRAINTS];
+    uint8_t local_lo[MAX_CONSTRAINTS];
+    uint8_t local_hi[MAX_CONSTRAINTS];
+    
+    // Carried constraints, one profile byte each
+    int num_carried;
+    uint64_t carried_masks[MAX_CONSTRAINTS];
+    uint8_t carried_shapes[MAX_CONSTRAINTS];
+    uint8_t carried_lo[MAX_CONSTRAINTS];
+    uint8_t carried_hi[MAX_CONSTRAINTS];
+} RowSweep;
+
+static inline int counted_in(const uint64_t* planes, uint64_t mask, uint8_t shape) {
+    uint64_t counted = planes[shape] | (shape != SHAPE_CAT ? planes[SHAPE_CAT] : 0);
+    return __builtin_popcountll(mask & counted);
+}
+
+/**
+ * Build the pattern classes of row r: every assignment of the row's cells
+ * allowed by their domains and the row-local constraints, keyed by its
+ * increments to the carried counts
+ */
+static bool build_row_classes(const RowSweep* sweep, int r, ProfileMap* classes) {
+    int w = sweep->width;
+    int first = r * w;
+    uint64_t row_mask = ((1ULL << w) - 1) << first;
+    uint8_t key[MAX_CONSTRAINTS] = {0};
+    
+    for (uint32_t code = 0; code < (1u << (2 * w)); code++) {
+        uint64_t planes[SHAPE_COUNT] = {0};
+        bool allowed = true;
+        
+        for (int x = 0; x < w && allowed; x++) {
+            uint8_t s = (code >> (2 * x)) & 3;
+            uint64_t bit = 1ULL << (first + x);
+            allowed = (sweep->domains[s] & bit) != 0;
+            planes[s] |= bit;
+        }
+        
+        for (int i = 0; i < sweep->num_local && allowed; i++) {
+            if ((sweep->local_masks[i] & row_mask) == 0) continue;
+            int count = counted_in(planes, sweep->local_masks[i], sweep->local_shapes[i]);
+            allowed = count >= sweep->local_lo[i] && count <= sweep->local_hi[i];
+        }
+        if (!allowed) continue;
+        
+        for (int k = 0; k < sweep->num_carried; k++) {
+            key[k] = counted_in(planes, sweep->carried_masks[k], sweep->carried_shapes[k]);
+        }
+        if (!map_add(classes, key, 1)) return false;
+    }
+    return true;
+}
+
+bool solver_count_solutions_dp(Puzzle* puzzle, SolverCount* count) {
+    solver_precompute_masks(puzzle);
+    
+    RowSweep sweep = { .width = puzzle->width, .height = puzzle->height };
+    int total = puzzle->width * puzzle->height;
+    uint64_t board_mask = (total == 64) ? ~0ULL : (1ULL << total) - 1;
+    uint64_t row_bits = (1ULL << puzzle->width) - 1;
+    
+    // Open cells (unlocked Cats) may take any shape; the rest are fixed
+    for (int i = 0; i < total; i++) {
+        uint64_t bit = 1ULL << i;
+        bool open = puzzle->board[i] == SHAPE_CAT && !(puzzle->locked_mask & bit);
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            if (open || puzzle->board[i] == s) sweep.domains[s] |= bit;
+        }
+    }
+    
+    for (int i = 0; i < puzzle->num_constraints; i++) {
+        const Constraint* c = &puzzle->constraints[i];
+        uint64_t mask = c->cell_mask & board_mask;
+        uint8_t lo, hi;
+        solver_constraint_bounds(c, &lo, &hi);
+        
+        int row = mask ? __builtin_ctzll(mask) / puzzle->width : 0;
+        bool local = mask && (mask & ~(row_bits << (row * puzzle->width))) == 0;
+        
+        if (local) {
+            int k = sweep.num_local++;
+            sweep.local_masks[k] = mask;
+            sweep.local_shapes[k] = c->shape;
+            sweep.local_lo[k] = lo;
+            sweep.local_hi[k] = hi;
+        } else {
+            int k = sweep.num_carried++;
+            sweep.carried_masks[k] = mask;
+            sweep.carried_shapes[k] = c->shape;
+            sweep.carried_lo[k] = lo;
+            sweep.carried_hi[k] = hi;
+        }
+    }
+    
+    int stride = (sweep.num_carried + 7) & ~7;
+    if (stride == 0) stride = 8;
+    
+    ProfileMap current = {0}, next = {0}, classes = {0};
+    bool ok = map_init(&current, stride) && map_init(&next, stride) && map_init(&classes, stride);
+    
+    uint8_t key[MAX_CONSTRAINTS] = {0};
+    ok = ok && map_add(&current, key, 1);
+    
+    for (int r = 0; r < sweep.height && ok && current.size > 0; r++) {
+        map_clear(&classes);
+        ok = build_row_classes(&sweep, r, &classes);
+        
+        // Cells of each carried region below this row, for the reach test
+        uint64_t below = board_mask & ~((2ULL << ((r + 1) * sweep.width - 1)) - 1);
+        uint8_t remaining[MAX_CONSTRAINTS];
+        for (int k = 0; k < sweep.num_carried; k++) {
+            remaining[k] = __builtin_popcountll(sweep.carried_masks[k] & below);
+        }
+        
+        map_clear(&next);
+        for (uint32_t e = 0; e < current.size && ok; e++) {
+            const uint8_t* profile = current.keys + (size_t)e * stride;
+            
+            for (uint32_t p = 0; p < classes.size && ok; p++) {
+                const uint8_t* inc = classes.keys + (size_t)p * stride;
+                bool live = true;
+                
+                for (int k = 0; k < sweep.num_carried; k++) {
+                    key[k] = profile[k] + inc[k];
+                    live &= key[k] <= sweep.carried_hi[k] &&
+                            key[k] + remaining[k] >= sweep.carried_lo[k];
+                }
+                if (!live) continue;
+                
+                ok = map_add(&next, key, current.counts[e] * classes.counts[p]) &&
+                     next.size <= DP_MAX_PROFILES;
+            }
+        }
+        
+        ProfileMap swap = current;
+        current = next;
+        next = swap;
+    }
+    
+    // After the last row the bound tests above are exact; checking again
+    // here also covers boards with no rows
+    SolverCount result = 0;
+    for (uint32_t e = 0; e < current.size && ok; e++) {
+        const uint8_t* profile = current.keys + (size_t)e * stride;
+        bool satisfied = true;
+        for (int k = 0; k < sweep.num_carried; k++) {
+            satisfied &= profile[k] >= sweep.carried_lo[k] && profile[k] <= sweep.carried_hi[k];
+        }
+        if (satisfied) result += current.counts[e];
+    }
+    
+    map_free(&current);
+    map_free(&next);
+    map_free(&classes);
+    
+    if (ok) *count = result;
+    return ok;
+}
@@ -0,0 +1,467 @@
+/**
+ * Schrödinger's Shapes - Row-Pattern Search Engine
+ * 
+ * Searches over whole rows instead of single cells:
+ * 1. For each row, every pattern (at most 4^MAX_WIDTH) allowed by the
+ *    row's fixed cells and its row-local constraints (row and cell
+ *    constraints) is tabulated once, with the amount it adds to every
+ *    other constraint's count
+ * 2. The search picks one pattern per row, keeping the carried counts
+ *    (columns, global) as one byte lane per constraint; a pattern is
+ *    rejected when a count passes its upper bound or can no longer reach
+ *    its lower bound with the rows left (a vector compare)
+ * 3. Subtree results are memoized on (row, carried counts): dead ends in
+ *    every mode, exact counts when counting, where patterns with equal
+ *    increments also share one subtree search
+ * 
+ * A 6x6 board is 6 levels of table-driven selection instead of 36 levels
+ * of cell recursion.
+ * 
+ * The tables and the memo live in one workspace that a solver context
+ * keeps between solves; the memo is invalidated in O(1) by a generation
+ * stamp, like the cell engine's transposition table.
+ */
+
+#include "solver.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Subtree memo slots (exact keys; a full slot run evicts its home slot)
+#define ROW_MEMO_SLOTS (1u << 15)
+#define ROW_MEMO_PROBES 4
+
+// Patterns of one row: every assignment of its cells
+#define ROW_MAX_PATTERNS (1u << (2 * MAX_WIDTH))
+
+// The deadline is polled every this many states (power of 2)
+#define ROW_DEADLINE_INTERVAL 1024
+
+/**
+ * One candidate assignment of a row
+ */
+typedef struct {
+    _Alignas(32) uint8_t inc[MAX_CONSTRAINTS];  // Added to each carried count
+    uint16_t code;                               // 2 bits per cell, x = 0 lowest
+    uint16_t run;                                // Patterns from here with equal inc
+} RowPattern;
+
+typedef struct {
+    uint8_t generation;    // Entry is empty unless this is the current one
+    uint8_t row_plus_one;
+    uint8_t counts[MAX_CONSTRAINTS];
+    uint64_t solutions;
+} RowMemoEntry;
+
+typedef struct {
+    const Puzzle* puzzle;
+    int width;
+    int height;
+    
+    // Carried constraints as byte lanes (unused lanes: [0, 255], no cells)
+    _Alignas(32) uint8_t lo[MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t hi[MAX_CONSTRAINTS];
+    
+    // Least and most that the rows after r can add to carried count k
+    _Alignas(32) uint8_t rest_min[MAX_HEIGHT][MAX_CONSTRAINTS];
+    _Alignas(32) uint8_t rest_max[MAX_HEIGHT][MAX_CONSTRAINTS];
+    
+    int num_patterns[MAX_HEIGHT];
+    uint16_t chosen[MAX_HEIGHT];
+    
+    uint64_t max_solutions;
+    uint64_t solution_count;
+    uint64_t states_explored;
+    uint64_t memo_hits;
+    uint64_t memo_misses;
+    uint8_t generation;    // Current memo generation, never 0
+    
+    SolverLimits limits;
+    SolveStatus status;
+    
+    uint8_t num_witnesses;
+    uint8_t witnesses[SOLVER_MAX_WITNESSES][MAX_CELLS];
+    
+    // Reused by every solve on this workspace
+    RowPattern patterns[MAX_HEIGHT][ROW_MAX_PATTERNS];
+    RowMemoEntry memo[ROW_MEMO_SLOTS];
+} RowSearch;
+
+static inline int counted_in(const uint64_t* planes, uint64_t mask, uint8_t shape) {
+    uint64_t counted = planes[shape] | (shape != SHAPE_CAT ? planes[SHAPE_CAT] : 0);
+    return __builtin_popcountll(mask & counted);
+}
+
+/**
+ * True if counts (after row r) can still satisfy every carried constraint
+ */
+static inline bool counts_feasible(const RowSearch* rs, const uint8_t* counts, int r) {
+#ifdef __AVX2__
+    __m256i c = _mm256_load_si256((const __m256i*)counts);
+    __m256i least = _mm256_adds_epu8(c, _mm256_load_si256((const __m256i*)rs->rest_min[r]));
+    __m256i most = _mm256_adds_epu8(c, _mm256_load_si256((const __m256i*)rs->rest_max[r]));
+    __m256i hi = _mm256_load_si256((const __m256i*)rs->hi);
+    __m256i lo = _mm256_load_si256((const __m256i*)rs->lo);
+    
+    // Unsigned a <= b  <=>  max(a, b) == b
+    __m256i ok = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(least, hi), hi),
+                                  _mm256_cmpeq_epi8(_mm256_max_epu8(most, lo), most));
+    return _mm256_movemask_epi8(ok) == -1;
+#else
+    bool ok = true;
+    for (int k = 0; k < MAX_CONSTRAINTS; k++) {
+        ok &= (counts[k] + rs->rest_min[r][k] <= rs->hi[k]) &
+              (counts[k] + rs->rest_max[r][k] >= rs->lo[k]);
+    }
+    return ok;
+#endif
+}
+
+static inline void add_counts(uint8_t* out, const uint8_t* counts, const uint8_t* inc) {
+#ifdef __AVX2__
+    __m256i sum = _mm256_adds_epu8(_mm256_load_si256((const __m256i*)counts),
+                                   _mm256_load_si256((const __m256i*)inc));
+    _mm256_store_si256((__m256i*)out, sum);
+#else
+    for (int k = 0; k < MAX_CONSTRAINTS; k++) {
+        int sum = counts[k] + inc[k];
+        out[k] = sum > UINT8_MAX ? UINT8_MAX : sum;
+    }
+#endif
+}
+
+static int compare_patterns(const void* a, const void* b) {
+    const RowPattern* pa = a;
+    const RowPattern* pb = b;
+    int order = memcmp(pa->inc, pb->inc, MAX_CONSTRAINTS);
+    return order ? order : (int)pa->code - (int)pb->code;
+}
+
+/**
+ * Split the constraints and tabulate every row's candidate patterns
+ */
+static void build_patterns(RowSearch* rs) {
+    const Puzzle* p = rs->puzzle;
+    int w = rs->width;
+    int total = w * rs->height;
+    uint64_t board_mask = (total == 64) ? ~0ULL : (1ULL << total) - 1;
+    uint64_t row_bits = (1ULL << w) - 1;
+    
+    // Open cells (unlocked Cats) may take any shape; the rest are fixed
+    uint64_t domains[SHAPE_COUNT] = {0};
+    for (int i = 0; i < total; i++) {
+        uint64_t bit = 1ULL << i;
+        bool open = p->board[i] == SHAPE_CAT && !(p->locked_mask & bit);
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            if (open || p->board[i] == s) domains[s] |= bit;
+        }
+    }
+    
+    int num_local = 0, num_carried = 0;
+    uint64_t local_masks[MAX_CONSTRAINTS], carried_masks[MAX_CONSTRAINTS];
+    uint8_t local_shapes[MAX_CONSTRAINTS], carried_shapes[MAX_CONSTRAINTS];
+    uint8_t local_lo[MAX_CONSTRAINTS], local_hi[MAX_CONSTRAINTS];
+    
+    memset(rs->lo, 0, sizeof(rs->lo));
+    memset(rs->hi, UINT8_MAX, sizeof(rs->hi));
+    memset(rs->rest_min, 0, sizeof(rs->rest_min));
+    memset(rs->rest_max, 0, sizeof(rs->rest_max));
+    
+    for (int i = 0; i < p->num_constraints; i++) {
+        const Constraint* c = &p->constraints[i];
+        uint64_t mask = c->cell_mask & board_mask;
+        uint8_t lo, hi;
+        solver_constraint_bounds(c, &lo, &hi);
+        
+        int row = mask ? __builtin_ctzll(mask) / w : 0;
+        if (mask && (mask & ~(row_bits << (row * w))) == 0) {
+            local_masks[num_local] = mask;
+            local_shapes[num_local] = c->shape;
+            local_lo[num_local] = lo;
+            local_hi[num_local] = hi;
+            num_local++;
+        } else {
+            int k = num_carried++;
+            carried_masks[k] = mask;
+            carried_shapes[k] = c->shape;
+            rs->lo[k] = lo;
+            rs->hi[k] = hi;
+        }
+    }
+    
+    for (int r = 0; r < rs->height; r++) {
+        int first = r * w;
+        uint64_t row_mask = row_bits << first;
+        uint32_t num_codes = 1u << (2 * w);
+        rs->num_patterns[r] = 0;
+        
+        for (uint32_t code = 0; code < num_codes; code++) {
+            uint64_t planes[SHAPE_COUNT] = {0};
+            bool allowed = true;
+            
+            for (int x = 0; x < w && allowed; x++) {
+                uint8_t s = (code >> (2 * x)) & 3;
+                uint64_t bit = 1ULL << (first + x);
+                allowed = (domains[s] & bit) != 0;
+                planes[s] |= bit;
+            }
+            
+            for (int i = 0; i < num_local && allowed; i++) {
+                if ((local_masks[i] & row_mask) == 0) continue;
+                int count = counted_in(planes, local_masks[i], local_shapes[i]);
+                allowed = count >= local_lo[i] && count <= local_hi[i];
+            }
+            if (!allowed) continue;
+            
+            RowPattern* pattern = &rs->patterns[r][rs->num_patterns[r]++];
+            memset(pattern->inc, 0, sizeof(pattern->inc));
+            for (int k = 0; k < num_carried; k++) {
+                pattern->inc[k] = counted_in(planes, carried_masks[k], carried_shapes[k]);
+            }
+            pattern->code = code;
+        }
+        
+        // Group equal increments so counting can search each group once
+        qsort(rs->patterns[r], rs->num_patterns[r], sizeof(RowPattern), compare_patterns);
+        for (int i = rs->num_patterns[r] - 1; i >= 0; i--) {
+            RowPattern* pattern = &rs->patterns[r][i];
+            bool same = i + 1 < rs->num_patterns[r] &&
+                        memcmp(pattern->inc, pattern[1].inc, MAX_CONSTRAINTS) == 0;
+            pattern->run = same ? pattern[1].run + 1 : 1;
+        }
+    }
+    
+    // Per-row increment ranges, summed over the rows below each row
+    for (int r = rs->height - 1; r > 0; r--) {
+        for (int k = 0; k < num_carried; k++) {
+            uint8_t least = UINT8_MAX, most = 0;
+            for (int i = 0; i < rs->num_patterns[r]; i++) {
+                uint8_t inc = rs->patterns[r][i].inc[k];
+                if (inc < least) least = inc;
+                if (inc > most) most = inc;
+            }
+            if (rs->num_patterns[r] == 0) least = 0;
+            rs->rest_min[r - 1][k] = rs->rest_min[r][k] + least;
+            rs->rest_max[r - 1][k] = rs->rest_max[r][k] + most;
+        }
+    }
+}
+
+/**
+ * Memo key for the rows from r on: the carried counts, with every
+ * constraint that the remaining rows can no longer violate replaced by
+ * 0xFF (r > 0)
+ */
+static inline void memo_key(const RowSearch* rs, int r, const uint8_t* counts, uint8_t* key) {
+#ifdef __AVX2__
+    __m256i c = _mm256_load_si256((const __m256i*)counts);
+    __m256i least = _mm256_adds_epu8(c, _mm256_load_si256((const __m256i*)rs->rest_min[r - 1]));
+    __m256i most = _mm256_adds_epu8(c, _mm256_load_si256((const __m256i*)rs->rest_max[r - 1]));
+    __m256i hi = _mm256_load_si256((const __m256i*)rs->hi);
+    __m256i lo = _mm256_load_si256((const __m256i*)rs->lo);
+    __m256i settled = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(least, lo), least),
+                                       _mm256_cmpeq_epi8(_mm256_max_epu8(most, hi), hi));
+    _mm256_store_si256((__m256i*)key, _mm256_or_si256(c, settled));
+#else
+    for (int k = 0; k < MAX_CONSTRAINTS; k++) {
+        bool settled = counts[k] + rs->rest_min[r - 1][k] >= rs->lo[k] &&
+                       counts[k] + rs->rest_max[r - 1][k] <= rs->hi[k];
+        key[k] = settled ? UINT8_MAX : counts[k];
+    }
+#endif
+}
+
+static RowMemoEntry* memo_find(RowSearch* rs, int r, const uint8_t* counts, bool* found) {
+    uint64_t h = (uint64_t)(r + 1) * 0x9E3779B97F4A7C15ULL;
+    for (int k = 0; k < MAX_CONSTRAINTS; k += 8) {
+        uint64_t word;
+        memcpy(&word, counts + k, 8);
+        h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+    }
+    
+    uint32_t home = h & (ROW_MEMO_SLOTS - 1);
+    for (int probe = 0; probe < ROW_MEMO_PROBES; probe++) {
+        RowMemoEntry* e = &rs->memo[(home + probe) & (ROW_MEMO_SLOTS - 1)];
+        if (e->generation != rs->generation) {
+            *found = false;
+            return e;
+        }
+        if (e->row_plus_one == r + 1 && memcmp(e->counts, counts, MAX_CONSTRAINTS) == 0) {
+            *found = true;
+            return e;
+        }
+    }
+    *found = false;
+    return &rs->memo[home];
+}
+
+static void record_solution(RowSearch* rs) {
+    rs->solution_count++;
+    if (rs->num_witnesses < SOLVER_MAX_WITNESSES) {
+        uint8_t* board = rs->witnesses[rs->num_witnesses++];
+        memset(board, SHAPE_CAT, MAX_CELLS);
+        for (int r = 0; r < rs->height; r++) {
+            for (int x = 0; x < rs->width; x++) {
+                board[r * rs->width + x] = (rs->chosen[r] >> (2 * x)) & 3;
+            }
+        }
+    }
+}
+
+static inline bool should_stop(RowSearch* rs) {
+    if (rs->status != SOLVE_COMPLETE) {
+        return true;
+    }
+    if (rs->max_solutions > 0 && rs->solution_count >= rs->max_solutions) {
+        return true;
+    }
+    if (rs->states_explored >= rs->limits.max_states) {
+        rs->status = SOLVE_BUDGET_EXHAUSTED;
+    } else if (rs->limits.cancel &&
+               atomic_load_explicit(rs->limits.cancel, memory_order_relaxed)) {
+        rs->status = SOLVE_CANCELLED;
+    } else if (rs->limits.deadline_ms > 0 &&
+               (rs->states_explored & (ROW_DEADLINE_INTERVAL - 1)) == 0 &&
+               solver_now_ms() >= rs->limits.deadline_ms) {
+        rs->status = SOLVE_BUDGET_EXHAUSTED;
+    }
+    return rs->status != SOLVE_COMPLETE;
+}
+
+/**
+ * Choose a pattern for row r given the carried counts of rows above
+ */
+static void search_rows(RowSearch* rs, int r, const uint8_t* counts) {
+    if (should_stop(rs)) {
+        return;
+    }
+    rs->states_explored++;
+    
+    if (r == rs->height) {
+        record_solution(rs);
+        return;
+    }
+    
+    // Rows below only see the carried counts. Dead ends are reused in every
+    // mode; non-zero counts only when counting, once the witnesses are in.
+    RowMemoEntry* memo_entry = NULL;
+    _Alignas(32) uint8_t key[MAX_CONSTRAINTS];
+    if (r > 0) {
+        bool found;
+        memo_key(rs, r, counts, key);
+        memo_entry = memo_find(rs, r, key, &found);
+        if (found && (memo_entry->solutions == 0 ||
+                      (rs->max_solutions == 0 && rs->num_witnesses == SOLVER_MAX_WITNESSES))) {
+            rs->memo_hits++;
+            rs->solution_count += memo_entry->solutions;
+            return;
+        }
+        rs->memo_misses++;
+    }
+    
+    uint64_t count_before = rs->solution_count;
+    _Alignas(32) uint8_t next[MAX_CONSTRAINTS];
+    
+    for (int i = 0; i < rs->num_patterns[r]; i++) {
+        const RowPattern* pattern = &rs->patterns[r][i];
+        add_counts(next, counts, pattern->inc);
+        if (!counts_feasible(rs, next, r)) {
+            i += pattern->run - 1;
+            continue;
+        }
+        
+        uint64_t child_before = rs->solution_count;
+        rs->chosen[r] = pattern->code;
+        search_rows(rs, r + 1, next);
+        if (should_stop(rs)) {
+            break;
+        }
+        
+        // The rest of the group leads to the same subtree; once the
+        // witnesses are taken it only needs counting
+        if (rs->max_solutions == 0 && rs->num_witnesses == SOLVER_MAX_WITNESSES) {
+            rs->solution_count += (rs->solution_count - child_before) * (pattern->run - 1);
+            i += pattern->run - 1;
+        }
+    }
+    
+    // Only a subtree searched to the end has an exact count
+    bool exhausted = rs->max_solutions == 0 || rs->solution_count < rs->max_solutions;
+    if (memo_entry && rs->status == SOLVE_COMPLETE && exhausted) {
+        memo_entry->generation = rs->generation;
+        memo_entry->row_plus_one = r + 1;
+        memcpy(memo_entry->counts, key, MAX_CONSTRAINTS);
+        memo_entry->solutions = rs->solution_count - count_before;
+    }
+}
+
+SolverResult solver_solve_rows_in(void** workspace, Puzzle* puzzle, uint64_t max_solutions,
+                                  const SolverLimits* limits) {
+    SolverResult result = {0};
+    solver_precompute_masks(puzzle);
+    
+    RowSearch* rs = workspace ? *workspace : NULL;
+    if (!rs) {
+        // Fresh workspace: zeroed, so every memo entry reads as empty
+        size_t bytes = (sizeof(RowSearch) + 63) & ~(size_t)63;
+        rs = aligned_alloc(64, bytes);
+        if (!rs) return result;
+        memset(rs, 0, bytes);
+        if (workspace) *workspace = rs;
+    }
+    
+    // Entries from older generations read as empty. Only when the 8-bit
+    // generation wraps does the memo need a real clear.
+    if (++rs->generation == 0) {
+        memset(rs->memo, 0, sizeof(rs->memo));
+        rs->generation = 1;
+    }
+    
+    rs->puzzle = puzzle;
+    rs->width = puzzle->width;
+    rs->height = puzzle->height;
+    rs->max_solutions = max_solutions;
+    rs->solution_count = 0;
+    rs->states_explored = 0;
+    rs->memo_hits = 0;
+    rs->memo_misses = 0;
+    rs->num_witnesses = 0;
+    rs->status = SOLVE_COMPLETE;
+    rs->limits = limits ? *limits : (SolverLimits){0};
+    if (rs->limits.max_states == 0) {
+        rs->limits.max_states = UINT64_MAX;
+    }
+    
+    clock_t start = clock();
+    
+    build_patterns(rs);
+    _Alignas(32) uint8_t counts[MAX_CONSTRAINTS] = {0};
+    search_rows(rs, 0, counts);
+    
+    clock_t end = clock();
+    
+    result.solution_count = rs->solution_count;
+    result.states_explored = rs->states_explored;
+    result.cache_hits = rs->memo_hits;
+    result.cache_misses = rs->memo_misses;
+    result.time_ms = ((double)(end - start) / CLOCKS_PER_SEC) * 1000.0;
+    result.is_solvable = rs->solution_count > 0;
+    result.status = rs->status;
+    result.num_witnesses = rs->num_witnesses;
+    memcpy(result.witnesses, rs->witnesses, sizeof(result.witnesses));
+    
+    if (!workspace) {
+        free(rs);
+    }
+    return result;
+}
+
+SolverResult solver_solve_rows(Puzzle* puzzle, uint64_t max_solutions,
+                               const SolverLimits* limits) {
+    return solver_solve_rows_in(NULL, puzzle, max_solutions, limits);
+}
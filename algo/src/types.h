@@ -87,14 +87,34 @@ typedef struct {
     Constraint display_constraints[MAX_DISPLAY_CONSTRAINTS];
 } Puzzle;
 
+// Solution boards kept by a solve (enough to show a puzzle is not unique)
+#define SOLVER_MAX_WITNESSES 2
+
+/**
+ * How a solve ended
+ */
+typedef enum {
+    SOLVE_COMPLETE,          // Search finished (counts exact up to max_solutions)
+    SOLVE_IN_PROGRESS,       // Paused by solver_step(); can be resumed
+    SOLVE_BUDGET_EXHAUSTED,  // Hit the state budget or deadline
+    SOLVE_CANCELLED          // Cancellation flag was raised
+} SolveStatus;
+
 /**
  * Solver result
  */
 typedef struct {
     uint64_t solution_count;
     uint64_t states_explored;
+    uint64_t cache_hits;    // Transposition table / count memo probes that hit
+    uint64_t cache_misses;  // Transposition table / count memo probes that missed
     double time_ms;
     bool is_solvable;
+    SolveStatus status;
+    
+    // The first solutions found, in search order (flat boards like Puzzle.board)
+    uint8_t num_witnesses;
+    uint8_t witnesses[SOLVER_MAX_WITNESSES][MAX_CELLS];
 } SolverResult;
 
 /**